@@ -0,0 +1,672 @@
+#define _NOM_IMPLEMENTATION_
+#include "../nom.h"
+
+#ifdef _WIN32
+    #error "bench.c needs a POSIX system (fork, getrusage, make and ninja)"
+#endif
+
+#include <sys/resource.h>
+
+// Generates a synthetic C project, builds it with nom, make and ninja and writes the timings as JSON.
+//
+//     cc -O2 -o nom-bench bench/bench.c
+//     ./nom-bench --tus=10000 --fanout=8 --depth=3 --out=bench.json
+
+typedef struct {
+    u32 Tus;
+    u32 Headers;
+    u32 Fanout;
+    u32 Depth;
+    u32 Jobs;
+    u32 Spawns;
+    u32 ScanHeaders;
+
+    const char* Dir;
+    const char* Out;
+    const char* NomH;
+    const char* Tools;
+} Bench_Options;
+
+typedef struct {
+    const char* Name;
+    _Bool Ran;
+    _Bool Failed;
+
+    i64 ColdMs;
+    i64 NoopMs;
+    i64 TouchMs;
+    i64 PeakRssKb;
+} Bench_Result;
+
+// TUs are grouped 100 per leaf directory, leaf L lives at src/l<L / 10^(D-1)>/.../l<L>.
+void Bench_LeafDir(u32 Leaf, u32 Depth, char* Out, u32 Size) {
+    u32 o = 0;
+    u32 Div = 1;
+
+    for (u32 k = 1; k < Depth; k++) Div *= 10;
+
+    for (u32 k = 0; k < Depth && o < Size; k++) {
+        o += snprintf(Out + o, Size - o, "%sl%u", k == 0 ? "" : "/", Leaf / Div);
+        Div = Div / 10 == 0 ? 1 : Div / 10;
+    }
+}
+
+u32 Bench_Random(u32* State) {
+    *State = *State * 1664525u + 1013904223u;
+    return *State >> 8;
+}
+
+FILE* Bench_Create(const char* Path) {
+    char* Dir = (char*)CONCAT(Path);
+    char* Sep = strrchr(Dir, '/');
+
+    if (Sep != NULL) {
+        *Sep = '\0';
+        __Nom_MkdirAll(Dir);
+    }
+
+    NOM_FREE(Dir);
+
+    FILE* file = Nom_FOpen(Path, "w");
+    if (file == NULL) NOM_ERROR("Unable to Write File: %s Error: %s", Path, strerror(errno));
+
+    return file;
+}
+
+// Headers form chains: every header includes up to two headers with a smaller index, so
+// including one header pulls in a deep part of the tree like real projects do.
+int Bench_WriteHeaders(const char* Dir, u32 Count) {
+    char Path[512];
+
+    for (u32 h = 0; h < Count; h++) {
+        snprintf(Path, sizeof(Path), "%s/g%u/h%u.h", Dir, h / 100, h);
+
+        FILE* file = Bench_Create(Path);
+        if (file == NULL) return -1;
+
+        fprintf(file, "#ifndef BENCH_H%u\n#define BENCH_H%u\n\n", h, h);
+
+        if (h > 0) fprintf(file, "#include \"g%u/h%u.h\"\n", (h - 1) / 100, h - 1);
+        if (h > 1) fprintf(file, "#include <g%u/h%u.h>\n", (h / 2) / 100, h / 2);
+
+        fprintf(file, "\n#define H%u_VALUE %u\n\n", h, h);
+        fprintf(file, "typedef struct { int a; long b; char c[%u]; } H%u_Struct;\n", 1 + h % 32, h);
+        fprintf(file, "static inline int h%u_get(const H%u_Struct* s) { return s->a + (int)s->b; }\n", h, h);
+        fprintf(file, "\n#endif\n");
+
+        fclose(file);
+    }
+
+    return 0;
+}
+
+int Bench_Generate(Bench_Options* opts) {
+    char Path[512], Leaf[256];
+
+    snprintf(Path, sizeof(Path), "%s/include", opts->Dir);
+    if (Bench_WriteHeaders(Path, opts->Headers) < 0) return -1;
+
+    for (u32 t = 0; t < opts->Tus; t++) {
+        Bench_LeafDir(t / 100, opts->Depth, Leaf, sizeof(Leaf));
+        snprintf(Path, sizeof(Path), "%s/src/%s/tu%u.c", opts->Dir, Leaf, t);
+
+        FILE* file = Bench_Create(Path);
+        if (file == NULL) return -1;
+
+        u32 State = t + 1;
+        u32 Last = 0;
+
+        for (u32 f = 0; f < opts->Fanout; f++) {
+            Last = Bench_Random(&State) % opts->Headers;
+            fprintf(file, "#include \"g%u/h%u.h\"\n", Last / 100, Last);
+        }
+
+        fprintf(file, "\nint tu%u(int x) {\n", t);
+        fprintf(file, "    for (int i = 0; i < %u; i++) x = x * 31 + i;\n", 8 + t % 16);
+        if (opts->Fanout > 0) {
+            fprintf(file, "    return x + H%u_VALUE;\n}\n", Last);
+        } else {
+            fprintf(file, "    return x;\n}\n");
+        }
+
+        fclose(file);
+    }
+
+    return 0;
+}
+
+int Bench_WriteNom(Bench_Options* opts) {
+    char Path[512];
+    snprintf(Path, sizeof(Path), "%s/nom.c", opts->Dir);
+
+    FILE* file = Bench_Create(Path);
+    if (file == NULL) return -1;
+
+    fprintf(file,
+        "#define _NOM_IMPLEMENTATION_\n"
+        "#include \"nom.h\"\n"
+        "\n"
+        "#include <sys/resource.h>\n"
+        "\n"
+        "#define TUS %u\n"
+        "#define DEPTH %u\n"
+        "#define JOBS %u\n"
+        "\n"
+        "void LeafDir(u32 Leaf, char* Out, u32 Size) {\n"
+        "    u32 o = 0, Div = 1;\n"
+        "    for (u32 k = 1; k < DEPTH; k++) Div *= 10;\n"
+        "\n"
+        "    for (u32 k = 0; k < DEPTH && o < Size; k++) {\n"
+        "        o += snprintf(Out + o, Size - o, \"%%sl%%u\", k == 0 ? \"\" : \"/\", Leaf / Div);\n"
+        "        Div = Div / 10 == 0 ? 1 : Div / 10;\n"
+        "    }\n"
+        "}\n"
+        "\n"
+        "int main(int argc, char** argv) {\n"
+        "    Nom_Config config = { \"bench\", argc > 1 ? argv[1] : \"build-nom\", {0} };\n"
+        "    Nom_CmdAppend(&config.Flags, \"-O0\", \"-Iinclude\");\n"
+        "\n"
+        "    Nom_Build build = {0};\n"
+        "    build.MaxJobs = JOBS;\n"
+        "\n"
+        "    char Leaf[256], Name[512];\n"
+        "\n"
+        "    for (u32 l = 0; l * 100 < TUS; l++) {\n"
+        "        LeafDir(l, Leaf, sizeof(Leaf));\n"
+        "\n"
+        "        Nom_Cmd ar = {0};\n"
+        "        snprintf(Name, sizeof(Name), \"lib/lib%%u.a\", l);\n"
+        "        const char* Library = Nom_ConfigPath(&config, Name);\n"
+        "        Nom_CmdAppend(&ar, \"ar\", \"rcs\", Library);\n"
+        "\n"
+        "        u32 Objects[100], Count = 0;\n"
+        "\n"
+        "        for (u32 t = l * 100; t < TUS && t < (l + 1) * 100; t++) {\n"
+        "            Nom_Cmd cmd = {0};\n"
+        "\n"
+        "            snprintf(Name, sizeof(Name), \"obj/%%s/tu%%u.o\", Leaf, t);\n"
+        "            const char* Object = Nom_ConfigPath(&config, Name);\n"
+        "\n"
+        "            snprintf(Name, sizeof(Name), \"src/%%s/tu%%u.c\", Leaf, t);\n"
+        "\n"
+        "            Nom_CmdAppend(&cmd, \"cc\");\n"
+        "            Nom_ConfigFlags(&config, &cmd);\n"
+        "            Nom_CmdAppend(&cmd, \"-c\", CONCAT(Name), \"-o\", Object);\n"
+        "\n"
+        "            Objects[Count++] = Nom_BuildJob(&build, cmd);\n"
+        "            Nom_CmdAppend(&ar, Object);\n"
+        "        }\n"
+        "\n"
+        "        u32 Archive = Nom_BuildJob(&build, ar);\n"
+        "        Nom_BuildOutput(&build, Archive, Library);\n"
+        "        for (u32 i = 0; i < Count; i++) Nom_BuildAfter(&build, Archive, Objects[i]);\n"
+        "    }\n"
+        "\n"
+        "    int Result = Nom_BuildRun(&build);\n"
+        "\n"
+        "    struct rusage Usage;\n"
+        "    getrusage(RUSAGE_SELF, &Usage);\n"
+        "\n"
+        "    FILE* rss = fopen(\"nom_rss.txt\", \"w\");\n"
+        "    if (rss != NULL) {\n"
+        "        fprintf(rss, \"%%ld\\n\", (long)Usage.ru_maxrss);\n"
+        "        fclose(rss);\n"
+        "    }\n"
+        "\n"
+        "    return Result < 0 ? 1 : 0;\n"
+        "}\n",
+        opts->Tus, opts->Depth, opts->Jobs);
+
+    fclose(file);
+
+    return 0;
+}
+
+int Bench_WriteMake(Bench_Options* opts) {
+    char Path[512], Leaf[256];
+    snprintf(Path, sizeof(Path), "%s/Makefile", opts->Dir);
+
+    FILE* file = Bench_Create(Path);
+    if (file == NULL) return -1;
+
+    fprintf(file, "BUILD ?= build-make\nCFLAGS = -O0 -Iinclude -MMD -MP\n\n");
+    fprintf(file, "$(BUILD)/obj/%%.o: src/%%.c\n\t@mkdir -p $(@D)\n\tcc $(CFLAGS) -c $< -o $@\n\n");
+
+    fprintf(file, "all:");
+    for (u32 l = 0; l * 100 < opts->Tus; l++) fprintf(file, " $(BUILD)/lib/lib%u.a", l);
+    fprintf(file, "\n\n");
+
+    for (u32 l = 0; l * 100 < opts->Tus; l++) {
+        Bench_LeafDir(l, opts->Depth, Leaf, sizeof(Leaf));
+
+        fprintf(file, "$(BUILD)/lib/lib%u.a:", l);
+        for (u32 t = l * 100; t < opts->Tus && t < (l + 1) * 100; t++) fprintf(file, " $(BUILD)/obj/%s/tu%u.o", Leaf, t);
+        fprintf(file, "\n\t@mkdir -p $(@D)\n\tar rcs $@ $^\n\n");
+    }
+
+    fprintf(file, "-include $(shell find $(BUILD) -name '*.d' 2>/dev/null)\n");
+    fclose(file);
+
+    return 0;
+}
+
+int Bench_WriteNinja(Bench_Options* opts) {
+    char Path[512], Leaf[256];
+    snprintf(Path, sizeof(Path), "%s/build.ninja", opts->Dir);
+
+    FILE* file = Bench_Create(Path);
+    if (file == NULL) return -1;
+
+    fprintf(file, "builddir = build-ninja\ncflags = -O0 -Iinclude\n\n");
+    fprintf(file, "rule cc\n  command = cc $cflags -MD -MF $out.d -c $in -o $out\n  depfile = $out.d\n  deps = gcc\n\n");
+    fprintf(file, "rule ar\n  command = ar rcs $out $in\n\n");
+
+    for (u32 l = 0; l * 100 < opts->Tus; l++) {
+        Bench_LeafDir(l, opts->Depth, Leaf, sizeof(Leaf));
+
+        for (u32 t = l * 100; t < opts->Tus && t < (l + 1) * 100; t++) {
+            fprintf(file, "build $builddir/obj/%s/tu%u.o: cc src/%s/tu%u.c\n", Leaf, t, Leaf, t);
+        }
+
+        fprintf(file, "build $builddir/lib/lib%u.a: ar", l);
+        for (u32 t = l * 100; t < opts->Tus && t < (l + 1) * 100; t++) fprintf(file, " $builddir/obj/%s/tu%u.o", Leaf, t);
+        fprintf(file, "\n\n");
+    }
+
+    fclose(file);
+
+    return 0;
+}
+
+// The generated nom driver leaves its own peak RSS in nom_rss.txt, compilers are not counted.
+i64 Bench_ReadRss(void) {
+    u8* Data = NULL;
+    u32 Length = 0;
+
+    if (__Nom_ReadAll("nom_rss.txt", &Data, &Length) < 0) return -1;
+
+    i64 Rss = strtol((char*)Data, NULL, 10);
+    NOM_FREE(Data);
+
+    return Rss;
+}
+
+// Runs cmd with its output sent to bench.log, returns the wall time in ms or -1 on failure.
+i64 Bench_Time(Nom_Cmd cmd) {
+    i64 Start = __Nom_NowMs();
+    int Status = __Nom_WaitStatus(__Nom_SpawnRedirect(cmd, "bench.log"));
+    i64 Elapsed = __Nom_NowMs() - Start;
+
+    if (Status != 0) {
+        NOM_ERROR("Benchmark command failed with exit code %i, see bench.log", Status);
+        return -1;
+    }
+
+    return Elapsed;
+}
+
+void Bench_Touch(const char* Path) {
+    // Rewriting the file guarantees a newer mtime even on filesystems with coarse timestamps.
+    u8* Data = NULL;
+    u32 Length = 0;
+
+    __Nom_SleepMs(1100);
+
+    if (__Nom_ReadAll(Path, &Data, &Length) == 0) {
+        __Nom_WriteAll(Path, Data, Length);
+        NOM_FREE(Data);
+    }
+}
+
+// Wipes a generated tree before it is rebuilt.
+int Bench_RemoveTree(const char* Dir) {
+    Nom_Cmd cmd = {0};
+    Nom_CmdAppend(&cmd, "rm", "-rf", Dir);
+
+    int Result = Nom_CmdRun(cmd);
+    Nom_FreeCmd(&cmd);
+    Nom_PathInvalidateAll();
+
+    return Result;
+}
+
+void Bench_Tool(Bench_Options* opts, Bench_Result* result, Nom_Cmd cmd, const char* BuildDir, _Bool ReadRss) {
+    char Touched[512], Leaf[256];
+
+    Bench_LeafDir(0, opts->Depth, Leaf, sizeof(Leaf));
+    snprintf(Touched, sizeof(Touched), "src/%s/tu0.c", Leaf);
+
+    NOM_INFO("Benchmarking %s", result->Name);
+
+    if (Nom_IsDir(BuildDir)) Bench_RemoveTree(BuildDir);
+    Nom_PathInvalidateAll();
+
+    i64* Runs[3] = { &result->ColdMs, &result->NoopMs, &result->TouchMs };
+
+    result->Ran = true;
+
+    for (u32 i = 0; i < 3; i++) {
+        if (i == 2) Bench_Touch(Touched);
+
+        *Runs[i] = Bench_Time(cmd);
+        if (*Runs[i] < 0) break;
+
+        i64 Rss = ReadRss ? Bench_ReadRss() : -1;
+        if (Rss > result->PeakRssKb) result->PeakRssKb = Rss;
+    }
+
+    result->Failed = result->ColdMs < 0 || result->NoopMs < 0 || result->TouchMs < 0;
+}
+
+// Mean latency in microseconds of Nom_CmdRun_Async + Nom_Wait on "true".
+double Bench_SpawnLatency(u32 Count) {
+    Nom_Cmd cmd = {0};
+    Nom_CmdAppend(&cmd, "true");
+
+    // Nom_CmdRun_Async logs every command, which is part of its cost but not worth a terminal full.
+    fflush(stdout);
+    int Saved = dup(STDOUT_FILENO);
+    int Null = open("/dev/null", O_WRONLY);
+    dup2(Null, STDOUT_FILENO);
+
+    i64 Start = __Nom_NowMs();
+    for (u32 i = 0; i < Count; i++) Nom_Wait(Nom_CmdRun_Async(cmd));
+    i64 Elapsed = __Nom_NowMs() - Start;
+
+    fflush(stdout);
+    dup2(Saved, STDOUT_FILENO);
+    close(Saved);
+    close(Null);
+
+    Nom_FreeCmd(&cmd);
+
+    return Count == 0 ? 0 : Elapsed * 1000.0 / Count;
+}
+
+#define BENCH_MICRO_ITERATIONS 200000
+
+void Bench_Micro(double* ConcatNs, double* InternNs, double* ExistNs) {
+    char Name[64];
+    i64 Start = __Nom_NowMs();
+
+    for (u32 i = 0; i < BENCH_MICRO_ITERATIONS; i++) {
+        NOM_FREE((char*)PATH("src", "module", "file.c"));
+    }
+
+    *ConcatNs = (__Nom_NowMs() - Start) * 1e6 / BENCH_MICRO_ITERATIONS;
+    Start = __Nom_NowMs();
+
+    for (u32 i = 0; i < BENCH_MICRO_ITERATIONS; i++) {
+        snprintf(Name, sizeof(Name), "./src//dir%u/./file%u.c", i % 1000, i);
+        Nom_PathIntern(Name);
+    }
+
+    *InternNs = (__Nom_NowMs() - Start) * 1e6 / BENCH_MICRO_ITERATIONS;
+    Start = __Nom_NowMs();
+
+    for (u32 i = 0; i < BENCH_MICRO_ITERATIONS; i++) {
+        Nom_Exist("nom.h");
+    }
+
+    *ExistNs = (__Nom_NowMs() - Start) * 1e6 / BENCH_MICRO_ITERATIONS;
+}
+
+typedef struct {
+    u32 Deps;
+    i64 ColdMs;
+    i64 WarmMs;
+} Bench_Scan;
+
+// Times Nom_ScanDeps over ScanHeaders chained headers, all reachable from one source. Cold starts
+// from an empty path table and scan cache (the files themselves are in the OS cache, having just
+// been written), warm scans the same command again in the same process.
+int Bench_ScanDeps(Bench_Options* opts, Bench_Scan* scan) {
+    if (Bench_WriteHeaders("scan/include", opts->ScanHeaders) < 0) return -1;
+
+    FILE* file = Bench_Create("scan/root.c");
+    if (file == NULL) return -1;
+
+    u32 Last = opts->ScanHeaders - 1;
+    fprintf(file, "#include \"g%u/h%u.h\"\n\nint root(void) { return H%u_VALUE; }\n", Last / 100, Last, Last);
+    fclose(file);
+
+    Nom_Cmd cmd = {0};
+    Nom_CmdAppend(&cmd, "cc", "-Iscan/include", "-c", "scan/root.c", "-o", "scan/root.o");
+
+    Nom_FreePaths();
+
+    Nom_Deps deps = {0};
+    i64 Start = __Nom_NowMs();
+
+    Nom_ScanDeps(cmd, &deps);
+    scan->ColdMs = __Nom_NowMs() - Start;
+    scan->Deps = deps.Count;
+
+    deps.Count = 0;
+    Start = __Nom_NowMs();
+
+    Nom_ScanDeps(cmd, &deps);
+    scan->WarmMs = __Nom_NowMs() - Start;
+
+    Nom_FreeDeps(&deps);
+    Nom_FreeCmd(&cmd);
+    Nom_FreePaths();
+
+    return 0;
+}
+
+void Bench_WriteResult(FILE* file, Bench_Result* result, u32 Tus, _Bool Last) {
+    fprintf(file, "    \"%s\": ", result->Name);
+
+    if (!result->Ran) {
+        fprintf(file, "null%s\n", Last ? "" : ",");
+        return;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "      \"ok\": %s,\n", result->Failed ? "false" : "true");
+    fprintf(file, "      \"cold_ms\": %ld,\n", (long)result->ColdMs);
+    fprintf(file, "      \"cold_tus_per_s\": %.1f,\n", result->ColdMs > 0 ? Tus * 1000.0 / result->ColdMs : 0.0);
+    fprintf(file, "      \"noop_ms\": %ld,\n", (long)result->NoopMs);
+    fprintf(file, "      \"touch_one_ms\": %ld", (long)result->TouchMs);
+
+    if (result->PeakRssKb >= 0) fprintf(file, ",\n      \"peak_driver_rss_kb\": %ld", (long)result->PeakRssKb);
+
+    fprintf(file, "\n    }%s\n", Last ? "" : ",");
+}
+
+_Bool Bench_Wants(Bench_Options* opts, const char* Tool) {
+    const char* At = strstr(opts->Tools, Tool);
+    u32 Length = strlen(Tool);
+
+    return At != NULL && (At == opts->Tools || At[-1] == ',') && (At[Length] == '\0' || At[Length] == ',');
+}
+
+int main(int argc, char** argv) {
+    Bench_Options opts = {0};
+
+    opts.Tus = 1000;
+    opts.Fanout = 8;
+    opts.Depth = 2;
+    opts.Jobs = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
+    opts.Spawns = 500;
+    opts.ScanHeaders = (u32)-1;
+    opts.Dir = "bench-project";
+    opts.Out = "bench.json";
+    opts.NomH = "nom.h";
+    opts.Tools = "nom,make,ninja";
+
+    for (int i = 1; i < argc; i++) {
+        const char* Arg = argv[i];
+
+        if (strncmp(Arg, "--tus=", 6) == 0) opts.Tus = atoi(Arg + 6);
+        else if (strncmp(Arg, "--headers=", 10) == 0) opts.Headers = atoi(Arg + 10);
+        else if (strncmp(Arg, "--fanout=", 9) == 0) opts.Fanout = atoi(Arg + 9);
+        else if (strncmp(Arg, "--depth=", 8) == 0) opts.Depth = atoi(Arg + 8);
+        else if (strncmp(Arg, "--jobs=", 7) == 0) opts.Jobs = atoi(Arg + 7);
+        else if (strncmp(Arg, "--spawns=", 9) == 0) opts.Spawns = atoi(Arg + 9);
+        else if (strncmp(Arg, "--scan-headers=", 15) == 0) opts.ScanHeaders = atoi(Arg + 15);
+        else if (strncmp(Arg, "--dir=", 6) == 0) opts.Dir = Arg + 6;
+        else if (strncmp(Arg, "--out=", 6) == 0) opts.Out = Arg + 6;
+        else if (strncmp(Arg, "--nom-h=", 8) == 0) opts.NomH = Arg + 8;
+        else if (strncmp(Arg, "--tools=", 8) == 0) opts.Tools = Arg + 8;
+        else {
+            NOM_ERROR("Unknown option: %s", Arg);
+            NOM_INFO("Usage: %s [--tus=N] [--headers=N] [--fanout=N] [--depth=N] [--jobs=N] [--spawns=N] [--scan-headers=N]", argv[0]);
+            NOM_INFO("       [--dir=PATH] [--out=FILE] [--nom-h=PATH] [--tools=nom,make,ninja]");
+            return 1;
+        }
+    }
+
+    if (opts.Headers == 0) opts.Headers = opts.Tus / 10 > 10 ? opts.Tus / 10 : 10;
+
+    // The scan follows the project size, 100 headers per TU and at most 100k.
+    if (opts.ScanHeaders == (u32)-1) opts.ScanHeaders = opts.Tus < 1000 ? opts.Tus * 100 : 100000;
+    if (opts.Tus == 0 || opts.Depth == 0 || opts.Jobs == 0) {
+        NOM_ERROR("--tus, --depth and --jobs must be at least 1");
+        return 1;
+    }
+
+    u8* NomH = NULL;
+    u32 NomHLength = 0;
+
+    if (__Nom_ReadAll(opts.NomH, &NomH, &NomHLength) < 0) {
+        NOM_ERROR("Unable to Read File: %s, run from the repository root or pass --nom-h", opts.NomH);
+        return 1;
+    }
+
+    u32 NomHHash = __Nom_PathHash((char*)NomH);
+
+    // Results are written relative to where the bench was started, the builds run inside the project.
+    char Cwd[4096];
+    if (getcwd(Cwd, sizeof(Cwd)) == NULL) return 1;
+
+    const char* Out = opts.Out[0] == '/' ? opts.Out : PATH(Cwd, opts.Out);
+
+    double ConcatNs, InternNs, ExistNs;
+    Bench_Micro(&ConcatNs, &InternNs, &ExistNs);
+
+    double SpawnUs = Bench_SpawnLatency(opts.Spawns);
+
+    NOM_INFO("Generating %u TUs, %u headers, fan-out %u, depth %u in %s", opts.Tus, opts.Headers, opts.Fanout, opts.Depth, opts.Dir);
+
+    i64 GenerateStart = __Nom_NowMs();
+
+    if (Nom_IsDir(opts.Dir)) Bench_RemoveTree(opts.Dir);
+    __Nom_MkdirAll(opts.Dir);
+
+    char Path[512];
+    snprintf(Path, sizeof(Path), "%s/nom.h", opts.Dir);
+
+    if (Bench_Generate(&opts) < 0 || Bench_WriteNom(&opts) < 0 || Bench_WriteMake(&opts) < 0 ||
+        Bench_WriteNinja(&opts) < 0 || __Nom_WriteAll(Path, NomH, NomHLength) < 0) {
+        return 1;
+    }
+
+    i64 GenerateMs = __Nom_NowMs() - GenerateStart;
+
+    if (chdir(opts.Dir) < 0) {
+        NOM_ERROR("Unable to enter %s Error: %s", opts.Dir, strerror(errno));
+        return 1;
+    }
+
+    Nom_PathInvalidateAll();
+
+    Bench_Scan Scan = { 0, -1, -1 };
+
+    if (opts.ScanHeaders > 0) {
+        NOM_INFO("Scanning includes of %u headers", opts.ScanHeaders);
+        if (Bench_ScanDeps(&opts, &Scan) < 0) return 1;
+    }
+
+    Bench_Result Results[3] = {
+        { "nom", false, false, -1, -1, -1, -1 },
+        { "make", false, false, -1, -1, -1, -1 },
+        { "ninja", false, false, -1, -1, -1, -1 },
+    };
+
+    char Jobs[32];
+    snprintf(Jobs, sizeof(Jobs), "-j%u", opts.Jobs);
+
+    if (Bench_Wants(&opts, "nom")) {
+        Nom_Cmd driver = {0};
+        Nom_CmdAppend(&driver, "cc", "-O2", "-o", "nom", "nom.c");
+
+        if (Bench_Time(driver) >= 0) {
+            Nom_Cmd cmd = {0};
+            Nom_CmdAppend(&cmd, "./nom", "build-nom");
+
+            Bench_Tool(&opts, &Results[0], cmd, "build-nom", true);
+
+            Nom_FreeCmd(&cmd);
+        }
+
+        Nom_FreeCmd(&driver);
+    }
+
+    if (Bench_Wants(&opts, "make")) {
+        char* Make = Nom_FindProgram("make");
+
+        if (Make != NULL) {
+            Nom_Cmd cmd = {0};
+            Nom_CmdAppend(&cmd, "make", "-s", Jobs);
+
+            Bench_Tool(&opts, &Results[1], cmd, "build-make", false);
+
+            Nom_FreeCmd(&cmd);
+            NOM_FREE(Make);
+        } else {
+            NOM_WARN("make not found, skipping");
+        }
+    }
+
+    if (Bench_Wants(&opts, "ninja")) {
+        char* Ninja = Nom_FindProgram("ninja");
+
+        if (Ninja != NULL) {
+            Nom_Cmd cmd = {0};
+            Nom_CmdAppend(&cmd, "ninja", Jobs);
+
+            Bench_Tool(&opts, &Results[2], cmd, "build-ninja", false);
+
+            Nom_FreeCmd(&cmd);
+            NOM_FREE(Ninja);
+        } else {
+            NOM_WARN("ninja not found, skipping");
+        }
+    }
+
+    FILE* file = Nom_FOpen(Out, "w");
+
+    if (file == NULL) {
+        NOM_ERROR("Unable to Write File: %s Error: %s", Out, strerror(errno));
+        return 1;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"nom_h_hash\": \"%08x\",\n", NomHHash);
+    fprintf(file, "  \"project\": { \"tus\": %u, \"headers\": %u, \"fanout\": %u, \"depth\": %u, \"jobs\": %u, \"generate_ms\": %ld },\n",
+            opts.Tus, opts.Headers, opts.Fanout, opts.Depth, opts.Jobs, (long)GenerateMs);
+    fprintf(file, "  \"spawn_latency_us\": %.1f,\n", SpawnUs);
+    fprintf(file, "  \"micro_ns\": { \"path_concat\": %.1f, \"path_intern\": %.1f, \"exist_cached\": %.1f },\n", ConcatNs, InternNs, ExistNs);
+
+    if (opts.ScanHeaders > 0) {
+        fprintf(file, "  \"scan\": { \"headers\": %u, \"deps\": %u, \"cold_ms\": %ld, \"warm_ms\": %ld },\n",
+                opts.ScanHeaders, Scan.Deps, (long)Scan.ColdMs, (long)Scan.WarmMs);
+    }
+
+    fprintf(file, "  \"tools\": {\n");
+
+    for (u32 i = 0; i < 3; i++) Bench_WriteResult(file, &Results[i], opts.Tus, i == 2);
+
+    fprintf(file, "  }\n}\n");
+    fclose(file);
+
+    NOM_INFO("Results written to %s", Out);
+
+    for (u32 i = 0; i < 3; i++) {
+        if (Results[i].Failed) return 1;
+    }
+
+    return 0;
+}
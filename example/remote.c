@@ -0,0 +1,170 @@
+// Runs two nom-worker instances on this host and compiles the example through them, then checks
+// that jobs still build when the only worker is busy or unreachable. Run from this directory:
+//     cc -o remote remote.c && ./remote
+#define _NOM_IMPLEMENTATION_
+#include "../nom.h"
+
+#define Compiler "cc"
+
+// Round-trips the transfer codec over inputs that hit its limits.
+int Codec(void) {
+    u32 Length = 70000;
+    u8* Random = NOM_ALLOC(Length);
+    u32 Seed = 1;
+
+    for (u32 i = 0; i < Length; i++) {
+        Seed = Seed * 1103515245 + 12345;
+        Random[i] = Seed >> 16;
+    }
+
+    // A match exactly 65535 bytes back, which the codec can reach, and one 65536 bytes back, which it can not.
+    memcpy(Random + 65535, Random, 64);
+    memcpy(Random + 65700, Random + 164, 64);
+
+    u8 Runs[1000];
+    memset(Runs, 'a', sizeof(Runs));
+
+    struct { const char* Name; const u8* Data; u32 Length; } Cases[] = {
+        { "empty", (const u8*)"", 0 },
+        { "one byte", (const u8*)"a", 1 },
+        { "below match length", (const u8*)"abc", 3 },
+        { "run longer than 131", Runs, sizeof(Runs) },
+        { "offsets near 65535", Random, Length },
+    };
+
+    int Result = 0;
+
+    for (u32 i = 0; i < sizeof(Cases) / sizeof(Cases[0]); i++) {
+        u8* Packed = NOM_ALLOC(NOM_COMPRESS_BOUND(Cases[i].Length));
+        u8* Unpacked = NOM_ALLOC(Cases[i].Length + 1);
+
+        u32 PackedLength = __Nom_Compress(Cases[i].Data, Cases[i].Length, Packed);
+
+        if (__Nom_Decompress(Packed, PackedLength, Unpacked, Cases[i].Length) < 0 ||
+            memcmp(Unpacked, Cases[i].Data, Cases[i].Length) != 0) {
+            NOM_ERROR("Codec: %s did not round-trip", Cases[i].Name);
+            Result = -1;
+        } else {
+            NOM_INFO("Codec: %s, %u -> %u bytes", Cases[i].Name, Cases[i].Length, PackedLength);
+        }
+
+        NOM_FREE(Packed);
+        NOM_FREE(Unpacked);
+    }
+
+    NOM_FREE(Random);
+
+    return Result;
+}
+
+Pid StartWorker(const char* Address, const char* Jobs) {
+    Nom_Cmd cmd = {0};
+    Nom_CmdAppend(&cmd, "./nom-worker", Address, Jobs, Compiler);
+
+    Pid proc = Nom_CmdRun_Async(cmd);
+    Nom_FreeCmd(&cmd);
+
+    // Wait until the worker accepts connections, the probe is dropped as soon as it is ready.
+    for (u32 i = 0; i < 100; i++) {
+        int Sock = __Nom_Socket(Address, false);
+
+        if (Sock >= 0) {
+            u32 Ready;
+            __Nom_RecvU32(Sock, &Ready);
+            close(Sock);
+
+            return proc;
+        }
+
+        __Nom_SleepMs(20);
+    }
+
+    NOM_ERROR("Worker did not start on: %s", Address);
+    return proc;
+}
+
+int Compile(Nom_Workers workers, const char* Source, const char* Object) {
+    Nom_Cmd cmd = {0};
+    Nom_CmdAppend(&cmd, Compiler, "-Wall", "-c", Source, "-o", Object);
+
+    if (Nom_Exist(Object)) Nom_RemoveFile(Object);
+    int Result = Nom_Wait(Nom_CmdRun_Remote(workers, cmd));
+    Nom_FreeCmd(&cmd);
+
+    if (Result < 0 || !Nom_Exist(Object)) {
+        NOM_ERROR("No object built for: %s", Source);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main( void ) {
+    #ifdef _WIN32
+        NOM_ERROR("Remote workers are not supported on Windows");
+        return 1;
+    #else
+        if (Codec() < 0) return 1;
+
+        Nom_Cmd cmd = {0};
+        Nom_CmdAppend(&cmd, Compiler, "-o", "nom-worker", "../nom-worker.c");
+        if (Nom_CmdRun(cmd) < 0) return 1;
+        cmd.Count = 0;
+
+        char A[64], B[64], Missing[64];
+        snprintf(A, sizeof(A), "unix:/tmp/nom-remote-%i-a.sock", (int)getpid());
+        snprintf(B, sizeof(B), "unix:/tmp/nom-remote-%i-b.sock", (int)getpid());
+        snprintf(Missing, sizeof(Missing), "unix:/tmp/nom-remote-%i-missing.sock", (int)getpid());
+
+        Pid WorkerA = StartWorker(A, "4");
+        Pid WorkerB = StartWorker(B, "1");
+
+        int Result = 0;
+
+        NOM_INFO("Compiling through both workers");
+        Nom_Workers both = {0};
+        Nom_WorkersAppend(&both, A, B);
+
+        if (Compile(both, "./main.c", "main.o") < 0) Result = -1;
+        if (Compile(both, "./hello.c", "hello.o") < 0) Result = -1;
+
+        Nom_CmdAppend(&cmd, Compiler, "main.o", "hello.o", "-o", "hello");
+        if (Nom_CmdRun(cmd) < 0) Result = -1;
+        Nom_FreeCmd(&cmd);
+
+        // Holding a connection keeps B's only job slot taken until it is closed.
+        NOM_INFO("Compiling while the only worker is busy");
+        int Held = __Nom_Socket(B, false);
+        u32 Ready;
+        __Nom_RecvU32(Held, &Ready);
+
+        Nom_Workers busy = {0};
+        Nom_WorkersAppend(&busy, B);
+
+        if (Compile(busy, "./hello.c", "hello.o") < 0) Result = -1;
+        close(Held);
+
+        NOM_INFO("Compiling with an unreachable worker");
+        Nom_Workers missing = {0};
+        Nom_WorkersAppend(&missing, Missing);
+
+        if (Compile(missing, "./hello.c", "hello.o") < 0) Result = -1;
+
+        __Nom_Kill(WorkerA);
+        __Nom_Kill(WorkerB);
+        __Nom_WaitStatus(WorkerA);
+        __Nom_WaitStatus(WorkerB);
+
+        remove(A + 5);
+        remove(B + 5);
+
+        Nom_FreeWorkers(&both);
+        Nom_FreeWorkers(&busy);
+        Nom_FreeWorkers(&missing);
+
+        if (Result < 0) return 1;
+
+        NOM_INFO("Remote workers OK");
+        return 0;
+    #endif
+}
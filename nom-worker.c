@@ -0,0 +1,13 @@
+#define _NOM_IMPLEMENTATION_
+#include "nom.h"
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        NOM_ERROR("Usage: %s <unix:/path/to/socket | host:port> <jobs> <compiler>...", argv[0]);
+        return 1;
+    }
+
+    u32 Jobs = (u32)atoi(argv[2]);
+
+    return Nom_WorkerServe(argv[1], Jobs, (const char**)argv + 3, argc - 3) < 0 ? 1 : 0;
+}
@@ -1,22 +1,41 @@
 #ifndef _NOM_H_
 #define _NOM_H_
 
+// A strict -std= hides the POSIX and BSD declarations nom uses (getaddrinfo, mkstemps,
+// CLOCK_MONOTONIC, st_mtim, ...). This only works if nom.h comes before any system header.
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+    #define _DEFAULT_SOURCE
+#endif
+
 #include <stdarg.h>
 #include <string.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <time.h>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
 
 #ifdef _WIN32
     #include <windows.h>
     #include <io.h>
+    #include <sys/stat.h>
 #else
-    #include <ftw.h>
     #include <unistd.h>
     #include <dirent.h>
+    #include <fcntl.h>
+    #include <netdb.h>
+    #include <signal.h>
     #include <sys/stat.h>
     #include <sys/wait.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <arpa/inet.h>
 #endif
 
 #ifdef _WIN32
@@ -55,15 +74,15 @@
         va_end(args);                                    \
     } while (0);
 
-#define DA_APPEND(da, item)                                              \
-    do {                                                                 \
-        if ((da)->Count >= (da)->Size) {                                 \
-            (da)->Size = (da)->Size == 0 ? DA_INIT_CAP : (da)->Size * 2; \
-            (da)->Items = NOM_REALLOC((da)->Items, (da)->Size);          \
-            NOM_ASSET((da)->Items != NULL);                              \
-        }                                                                \
-        (da)->Items[(da)->Count] = item;                                 \
-        (da)->Count += 1;                                                \
+#define DA_APPEND(da, item)                                                            \
+    do {                                                                               \
+        if ((da)->Count >= (da)->Size) {                                               \
+            (da)->Size = (da)->Size == 0 ? DA_INIT_CAP : (da)->Size * 2;               \
+            (da)->Items = NOM_REALLOC((da)->Items, (da)->Size * sizeof(*(da)->Items)); \
+            NOM_ASSET((da)->Items != NULL);                                            \
+        }                                                                              \
+        (da)->Items[(da)->Count] = item;                                               \
+        (da)->Count += 1;                                                              \
     } while (0)
 
 #define DA_FOREACH(da, type, element, body)     \
@@ -129,6 +148,45 @@ typedef struct {
     u32 Size;
 } Nom_SB;
 
+// ------------------------------------------
+// ------------------ PATHS -----------------
+// ------------------------------------------
+
+// Every path the file API sees is normalized and interned once, the ID stays valid for the
+// whole process and its stat result is cached until nom writes to that path or it is invalidated.
+typedef u32 Nom_PathId;
+
+// Writing is set for paths opened for writing through Nom_FOpen. nom does not see the fclose, so
+// they are statted every time until the next Nom_PathInvalidate of that path.
+// Names and Kinds hold the listing of a directory once it was read, it is dropped together with
+// the stat, and creating or removing an entry invalidates the directory holding it.
+typedef struct {
+    char* Path;
+    u32 Hash;
+    _Bool Statted;
+    _Bool Writing;
+    _Bool Exists;
+    struct stat Stat;
+
+    _Bool Listed;
+    u32 NameCount;
+    char** Names;
+    u8* Kinds;
+} Nom_PathEntry;
+
+Nom_PathId Nom_PathIntern(const char* Path);
+const char* Nom_PathStr(Nom_PathId Id);
+
+_Bool Nom_PathStat(Nom_PathId Id, struct stat* Stat);
+
+void Nom_PathInvalidate(const char* Path);
+void Nom_PathInvalidateAll(void);
+
+void Nom_FreePaths(void);
+
+void __Nom_ScanForget(Nom_PathId Id);
+void __Nom_FreeScans(void);
+
 // ------------------------------------------
 // ------------------ FILE ------------------
 // ------------------------------------------
@@ -158,6 +216,9 @@ int Nom_ReadFile(const char* Path, char* Buffer);
 int Nom_WriteFile(const char* Path, const char* Buffer, _Bool Append);
 
 _Bool Nom_Exist(const char* Path);
+_Bool Nom_IsDir(const char* Path);
+
+i64 Nom_Mtime(const char* Path);
 
 // ------------------------------------------
 // ------------------- API ------------------
@@ -179,20 +240,475 @@ void Nom_ShowCmd(Nom_Cmd cmd, Nom_SB* sb);
 Pid Nom_CmdRun_Async(Nom_Cmd cmd);
 int Nom_CmdRun_Sync(Nom_Cmd cmd);
 
+void __Nom_CmdInvalidateOutput(Nom_Cmd cmd);
+void __Nom_ProcTrack(Pid proc, Nom_Cmd cmd);
+void __Nom_ProcDone(Pid proc);
+
 int Nom_Wait(Pid proc);
 
+// With an OutPath the child gets its own process group (a Job Object on Windows), so __Nom_Kill
+// also takes down whatever it started. Children sharing the terminal stay in nom's group so
+// Ctrl-C and terminal input still reach them.
+Pid __Nom_SpawnRedirect(Nom_Cmd cmd, const char* OutPath);
+int __Nom_WaitStatus(Pid proc);
+int __Nom_TryWait(Pid proc, int* ExitCode);
+void __Nom_Kill(Pid proc);
+
+i64 __Nom_NowMs(void);
+void __Nom_SleepMs(u32 Ms);
+
 void Nom_FreeSB(Nom_SB* sb);
 void Nom_FreeCmd(Nom_Cmd* cmd);
 
+// ------------------------------------------
+// ----------------- REMOTE -----------------
+// ------------------------------------------
+
+// Workers are addressed as "unix:/path/to/socket" or "host:port".
+// A worker only runs jobs whose compiler (argv[0]) is one of Compilers, compared verbatim, with a
+// single -o and otherwise only code generation and diagnostic flags (-D, -I, -O, -g, -f, -m, -W, ...).
+typedef struct {
+    const char** Items;
+    u32 Count;
+    u32 Size;
+} Nom_Workers;
+
+#define NOM_WORKER_JOBS 4
+
+#define Nom_WorkersAppend(workers, ...) __Nom_WorkersAppend(workers, __VA_ARGS__, NULL);
+
+void __Nom_WorkersAppend(Nom_Workers* workers, ...);
+
+Pid Nom_CmdRun_Remote(Nom_Workers workers, Nom_Cmd cmd);
+int Nom_WorkerServe(const char* Address, u32 MaxJobs, const char** Compilers, u32 CompilerCount);
+
+void Nom_FreeWorkers(Nom_Workers* workers);
+
+// ------------------------------------------
+// ----------------- CHECKS -----------------
+// ------------------------------------------
+
+#ifndef NOM_CACHE_DIR
+    #define NOM_CACHE_DIR ".nom"
+#endif
+
+#define NOM_CHECK_JOBS 16
+
+typedef enum {
+    NOM_CHECK_FLAG,
+    NOM_CHECK_HEADER,
+    NOM_CHECK_FUNCTION
+} Nom_CheckKind;
+
+typedef struct {
+    Nom_CheckKind Kind;
+    const char* Compiler;
+    const char* Arg;
+    _Bool* Result;
+} Nom_Check;
+
+typedef struct {
+    Nom_Check* Items;
+    u32 Count;
+    u32 Size;
+} Nom_Checks;
+
+// Checks are only queued here, Nom_CheckRun fills in every Result at once.
+// Flag may hold several space separated flags which are tested together.
+void Nom_CheckCompilerFlag(Nom_Checks* checks, const char* Compiler, const char* Flag, _Bool* Result);
+void Nom_CheckHeader(Nom_Checks* checks, const char* Compiler, const char* Header, _Bool* Result);
+void Nom_CheckFunction(Nom_Checks* checks, const char* Compiler, const char* Function, _Bool* Result);
+
+int Nom_CheckRun(Nom_Checks* checks);
+
+char* Nom_FindProgram(const char* Name);
+
+void Nom_FreeChecks(Nom_Checks* checks);
+
+// ------------------------------------------
+// ---------------- FAST LINK ---------------
+// ------------------------------------------
+
+typedef struct {
+    const char* Linker;
+    _Bool SplitDwarf;
+    _Bool GdbIndex;
+} Nom_FastLink;
+
+// Picks mold, then lld, then gold (Linker stays NULL if none works) and whether split DWARF
+// and --gdb-index are usable. Results go through the Nom_CheckRun cache.
+int Nom_FastLinkProbe(const char* Compiler, Nom_FastLink* fl);
+
+void Nom_FastLinkCompileFlags(Nom_FastLink fl, Nom_Cmd* cmd);
+void Nom_FastLinkLinkFlags(Nom_FastLink fl, Nom_Cmd* cmd);
+
+// ------------------------------------------
+// ------------------ TEST ------------------
+// ------------------------------------------
+
+#define NOM_TEST_JOBS 8
+
+typedef struct {
+    const char* Name;
+    Nom_Cmd Cmd;
+
+    i64 Expected;
+    i64 Duration;
+    u32 Attempts;
+    _Bool Selected;
+    _Bool Passed;
+    _Bool TimedOut;
+} Nom_TestCase;
+
+typedef struct {
+    Nom_TestCase* Items;
+    u32 Count;
+    u32 Size;
+
+    u32 MaxJobs;
+    u32 TimeoutMs;
+    u32 Retries;
+    u32 Shard;
+    u32 ShardCount;
+} Nom_Tests;
+
+#define Nom_TestAdd(tests, name, ...) __Nom_TestAdd(tests, name, __VA_ARGS__, NULL);
+
+void __Nom_TestAdd(Nom_Tests* tests, const char* Name, ...);
+
+// Understands --shard=i/n (1 based), --jobs=N, --timeout=SECONDS and --retries=N.
+int Nom_TestArgs(Nom_Tests* tests, int argc, char** argv);
+int Nom_TestRun(Nom_Tests* tests);
+
+void Nom_FreeTests(Nom_Tests* tests);
+
+// ------------------------------------------
+// ------------------ SCAN ------------------
+// ------------------------------------------
+
+#define NOM_NO_PATH ((Nom_PathId)-1)
+
+typedef struct {
+    Nom_PathId* Items;
+    u32 Count;
+    u32 Size;
+} Nom_Deps;
+
+// Conservatively collects every header the sources in cmd may include, using the -I, -iquote and
+// -isystem paths of cmd. Includes are found textually so conditional ones are always followed.
+// An include that can not be found is recorded under every directory it would be searched in, so
+// a job generating it can be ordered first. Files forced in with -include or -imacros are scanned
+// like sources.
+int Nom_ScanDeps(Nom_Cmd cmd, Nom_Deps* deps);
+
+// True if the -o output of cmd is missing or older than any input or scanned header.
+_Bool Nom_CmdIsStale(Nom_Cmd cmd);
+_Bool __Nom_CmdIsStaleOutputs(Nom_Cmd cmd, const Nom_PathId* Outputs, u32 OutputCount);
+
+void Nom_FreeDeps(Nom_Deps* deps);
+
+// ------------------------------------------
+// ------------------ BUILD -----------------
+// ------------------------------------------
+
+#define NOM_BUILD_JOBS 8
+
+typedef struct {
+    const char* Name;
+    const char* OutDir;
+    Nom_Cmd Flags;
+} Nom_Config;
+
+typedef struct {
+    u32* Items;
+    u32 Count;
+    u32 Size;
+} Nom_JobDeps;
+
+typedef struct {
+    Nom_PathId* Items;
+    u32 Count;
+    u32 Size;
+} Nom_JobOutputs;
+
+typedef struct {
+    Nom_Cmd Cmd;
+    Nom_JobDeps Deps;
+    Nom_JobOutputs Outputs;
+    u32 Config;
+
+    u32 Waiting;
+    _Bool DepRan;
+    _Bool Ran;
+    _Bool Failed;
+} Nom_Job;
+
+typedef struct {
+    Nom_Job* Items;
+    u32 Count;
+    u32 Size;
+
+    const Nom_Config* Config;
+    u32 ConfigIndex;
+    u32 ConfigCount;
+    u32 MaxJobs;
+} Nom_Build;
+
+typedef void (*Nom_Targets)(Nom_Build* build, const Nom_Config* config);
+
+// The job owns cmd from here on. A job only runs once all jobs it is after have finished, and only
+// if one of them ran or Nom_CmdIsStale(cmd) says so. Nom_BuildRun also puts every job after the
+// jobs whose outputs it reads or includes, so generated headers exist before they are compiled.
+u32 Nom_BuildJob(Nom_Build* build, Nom_Cmd cmd);
+void Nom_BuildAfter(Nom_Build* build, u32 Job, u32 Dep);
+
+// Declares a file Job writes, for commands without -o (ar, code generators, copies). Once a job
+// has declared outputs they replace its -o for the staleness check and stat cache invalidation.
+void Nom_BuildOutput(Nom_Build* build, u32 Job, const char* Path);
+
+int Nom_BuildRun(Nom_Build* build);
+
+// Instantiates Targets once per configuration into one graph and runs it on a single pool of
+// MaxJobs, so the stat cache, include scans and job slots are shared between configurations.
+int Nom_BuildConfigs(const Nom_Config* Configs, u32 Count, Nom_Targets Targets, u32 MaxJobs);
+
+void Nom_ConfigFlags(const Nom_Config* config, Nom_Cmd* cmd);
+const char* Nom_ConfigPath(const Nom_Config* config, const char* Name);
+
+void Nom_FreeBuild(Nom_Build* build);
+
 #endif // _NOM_H_
 
 #ifdef _NOM_IMPLEMENTATION_
 
+// ------------------------------------------
+// ------------------ PATHS -----------------
+// ------------------------------------------
+
+struct {
+    Nom_PathEntry* Items;
+    u32 Count;
+    u32 Size;
+
+    u32* Slots;
+    u32 SlotCount;
+} __Nom_Paths = {0};
+
+u32 __Nom_PathHash(const char* Path) {
+    u32 Hash = 2166136261u;
+
+    while (*Path != '\0') {
+        Hash ^= (u8)*Path;
+        Hash *= 16777619u;
+        Path += 1;
+    }
+
+    return Hash;
+}
+
+// Collapses repeated separators and "." components, ".." is kept as symlinks make it ambiguous.
+char* __Nom_PathNormalize(const char* Path) {
+    u32 Length = strlen(Path);
+    char* Out = NOM_ALLOC(Length + 2);
+    u32 o = 0;
+
+    #ifdef _WIN32
+        #define __NOM_IS_SEP(chr) ((chr) == '/' || (chr) == '\\')
+    #else
+        #define __NOM_IS_SEP(chr) ((chr) == '/')
+    #endif
+
+    if (__NOM_IS_SEP(Path[0])) Out[o++] = PATH_SEP;
+
+    #ifdef _WIN32
+        // UNC paths (\\server\share) keep their leading double separator.
+        if (__NOM_IS_SEP(Path[0]) && __NOM_IS_SEP(Path[1])) Out[o++] = PATH_SEP;
+    #endif
+
+    u32 i = 0;
+    while (i < Length) {
+        while (i < Length && __NOM_IS_SEP(Path[i])) i += 1;
+
+        u32 Start = i;
+        while (i < Length && !__NOM_IS_SEP(Path[i])) i += 1;
+
+        u32 Len = i - Start;
+        if (Len == 0 || (Len == 1 && Path[Start] == '.')) continue;
+
+        if (o > 0 && Out[o - 1] != PATH_SEP) Out[o++] = PATH_SEP;
+
+        memcpy(Out + o, Path + Start, Len);
+        o += Len;
+    }
+
+    #undef __NOM_IS_SEP
+
+    if (o == 0) Out[o++] = '.';
+    Out[o] = '\0';
+
+    return Out;
+}
+
+void __Nom_PathGrow(void) {
+    u32 SlotCount = __Nom_Paths.SlotCount == 0 ? 1024 : __Nom_Paths.SlotCount * 2;
+    u32* Slots = NOM_ALLOC(SlotCount * sizeof(u32));
+    NOM_ASSET(Slots != NULL);
+
+    memset(Slots, 0, SlotCount * sizeof(u32));
+
+    for (u32 Id = 0; Id < __Nom_Paths.Count; Id++) {
+        u32 Slot = __Nom_Paths.Items[Id].Hash & (SlotCount - 1);
+        while (Slots[Slot] != 0) Slot = (Slot + 1) & (SlotCount - 1);
+
+        Slots[Slot] = Id + 1;
+    }
+
+    NOM_FREE(__Nom_Paths.Slots);
+    __Nom_Paths.Slots = Slots;
+    __Nom_Paths.SlotCount = SlotCount;
+}
+
+// Returns the slot holding Normalized, or the empty slot it would be inserted at.
+u32 __Nom_PathFind(const char* Normalized, u32 Hash) {
+    u32 Mask = __Nom_Paths.SlotCount - 1;
+    u32 Slot = Hash & Mask;
+
+    while (__Nom_Paths.Slots[Slot] != 0) {
+        Nom_PathEntry* Entry = &__Nom_Paths.Items[__Nom_Paths.Slots[Slot] - 1];
+        if (Entry->Hash == Hash && strcmp(Entry->Path, Normalized) == 0) break;
+
+        Slot = (Slot + 1) & Mask;
+    }
+
+    return Slot;
+}
+
+Nom_PathId Nom_PathIntern(const char* Path) {
+    if ((__Nom_Paths.Count + 1) * 2 > __Nom_Paths.SlotCount) __Nom_PathGrow();
+
+    char* Normalized = __Nom_PathNormalize(Path);
+    u32 Hash = __Nom_PathHash(Normalized);
+    u32 Slot = __Nom_PathFind(Normalized, Hash);
+
+    if (__Nom_Paths.Slots[Slot] != 0) {
+        NOM_FREE(Normalized);
+        return __Nom_Paths.Slots[Slot] - 1;
+    }
+
+    Nom_PathEntry Entry = {0};
+    Entry.Path = Normalized;
+    Entry.Hash = Hash;
+
+    DA_APPEND(&__Nom_Paths, Entry);
+    __Nom_Paths.Slots[Slot] = __Nom_Paths.Count;
+
+    return __Nom_Paths.Count - 1;
+}
+
+const char* Nom_PathStr(Nom_PathId Id) {
+    NOM_ASSET(Id < __Nom_Paths.Count);
+    return __Nom_Paths.Items[Id].Path;
+}
+
+_Bool Nom_PathStat(Nom_PathId Id, struct stat* Stat) {
+    NOM_ASSET(Id < __Nom_Paths.Count);
+    Nom_PathEntry* Entry = &__Nom_Paths.Items[Id];
+
+    if (!Entry->Statted || Entry->Writing) {
+        Entry->Exists = stat(Entry->Path, &Entry->Stat) == 0;
+        Entry->Statted = true;
+    }
+
+    if (Entry->Exists && Stat != NULL) *Stat = Entry->Stat;
+
+    return Entry->Exists;
+}
+
+void __Nom_PathUnlist(Nom_PathEntry* Entry) {
+    for (u32 i = 0; i < Entry->NameCount; i++) {
+        NOM_FREE(Entry->Names[i]);
+    }
+
+    NOM_FREE(Entry->Names);
+    NOM_FREE(Entry->Kinds);
+
+    Entry->Listed = false;
+    Entry->NameCount = 0;
+    Entry->Names = NULL;
+    Entry->Kinds = NULL;
+}
+
+void __Nom_PathInvalidateNormalized(const char* Normalized) {
+    u32 Slot = __Nom_PathFind(Normalized, __Nom_PathHash(Normalized));
+    if (__Nom_Paths.Slots[Slot] == 0) return;
+
+    Nom_PathEntry* Entry = &__Nom_Paths.Items[__Nom_Paths.Slots[Slot] - 1];
+    Entry->Statted = false;
+    Entry->Writing = false;
+    __Nom_PathUnlist(Entry);
+}
+
+void Nom_PathInvalidate(const char* Path) {
+    if (__Nom_Paths.Count == 0) return;
+
+    char* Normalized = __Nom_PathNormalize(Path);
+    u32 Slot = __Nom_PathFind(Normalized, __Nom_PathHash(Normalized));
+
+    if (__Nom_Paths.Slots[Slot] != 0) {
+        __Nom_PathInvalidateNormalized(Normalized);
+        __Nom_ScanForget(__Nom_Paths.Slots[Slot] - 1);
+    }
+
+    // Creating or removing an entry also changes the directory holding it, a root keeps its separator.
+    char* Sep = strrchr(Normalized, PATH_SEP);
+
+    if (Sep == NULL) {
+        __Nom_PathInvalidateNormalized(".");
+    } else {
+        _Bool Root = Sep == Normalized || Sep[-1] == ':' || Sep[-1] == PATH_SEP;
+        Sep[Root ? 1 : 0] = '\0';
+
+        __Nom_PathInvalidateNormalized(Normalized);
+    }
+
+    NOM_FREE(Normalized);
+}
+
+void Nom_PathInvalidateAll(void) {
+    for (u32 Id = 0; Id < __Nom_Paths.Count; Id++) {
+        __Nom_Paths.Items[Id].Statted = false;
+        __Nom_Paths.Items[Id].Writing = false;
+        __Nom_PathUnlist(&__Nom_Paths.Items[Id]);
+        __Nom_ScanForget(Id);
+    }
+}
+
+void Nom_FreePaths(void) {
+    __Nom_FreeScans();
+
+    for (u32 Id = 0; Id < __Nom_Paths.Count; Id++) {
+        __Nom_PathUnlist(&__Nom_Paths.Items[Id]);
+        NOM_FREE(__Nom_Paths.Items[Id].Path);
+    }
+
+    NOM_FREE(__Nom_Paths.Items);
+    NOM_FREE(__Nom_Paths.Slots);
+
+    memset(&__Nom_Paths, 0, sizeof(__Nom_Paths));
+}
+
 // ------------------------------------------
 // ------------------ FILE ------------------
 // ------------------------------------------
 
 FILE* Nom_FOpen(const char* Path, const char* mode) {
+    if (strpbrk(mode, "wa+") != NULL) {
+        Nom_PathId Id = Nom_PathIntern(Path);
+
+        Nom_PathInvalidate(Path);
+        __Nom_Paths.Items[Id].Writing = true;
+    }
+
     #ifdef _WIN32
         FILE* file;
         fopen_s(&file, Path, mode);
@@ -216,12 +732,14 @@ int __Nom_Mkdir(int Ignore, ...) {
                 return -1;
             }
         #endif
+
+        Nom_PathInvalidate(Path);
     })
 
     return 0;
 }
 
-int __Nom_TouchFiles(int Ignore, ...) {
+int __Nom_TouchFile(int Ignore, ...) {
     va_list args;
     VA_ARGS_FOREACH(args, Path, const char*, Ignore, {
         FILE* File = Nom_FOpen(Path, "w");
@@ -232,6 +750,7 @@ int __Nom_TouchFiles(int Ignore, ...) {
         }
 
         fclose(File);
+        Nom_PathInvalidate(Path);
     })
 
     return 0;
@@ -244,13 +763,40 @@ int __Nom_RemoveFile(int Ignore, ...) {
             NOM_ERROR("Unable to Remove File: %s Error: %s", Path, strerror(errno));
             return -1;
         }
+
+        Nom_PathInvalidate(Path);
     })
 
     return 0;
 }
 
 #ifndef _WIN32
-    int __Nom_HELPER_DIR_Remove(const char *fpath, const struct stat *sb, int typeflag) {
+    // Removes the contents of a directory before the directory itself, symlinks are not followed.
+    int __Nom_HELPER_DIR_Remove(const char *fpath) {
+        struct stat sb;
+        if (lstat(fpath, &sb) < 0) return -1;
+
+        if (S_ISDIR(sb.st_mode)) {
+            DIR* dir = opendir(fpath);
+            if (dir == NULL) return -1;
+
+            struct dirent* ent;
+            while ((ent = readdir(dir)) != NULL) {
+                if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+
+                char* Child = (char*)PATH(fpath, ent->d_name);
+                int rv = __Nom_HELPER_DIR_Remove(Child);
+                NOM_FREE(Child);
+
+                if (rv < 0) {
+                    closedir(dir);
+                    return -1;
+                }
+            }
+
+            closedir(dir);
+        }
+
         int rv = remove(fpath);
         return rv;
     }
@@ -286,11 +832,14 @@ int __Nom_RemoveDir(int Ignore, ...) {
                 return -1;
             }
         #else
-            if (ftw(Path, __Nom_HELPER_DIR_Remove, FTW_D | FTW_DNR | FTW_F | FTW_NS) < 0) {
+            if (__Nom_HELPER_DIR_Remove(Path) < 0) {
                 NOM_ERROR("Unable to Remove Dir: %s Error: %s", Path, strerror(errno));
                 return -1;
             }
         #endif
+
+        // Anything below Path may have been cached, so drop the whole cache.
+        Nom_PathInvalidateAll();
     })
 
     return 0;
@@ -302,190 +851,125 @@ int Nom_Move(const char* Path, const char* NewPath) {
         return -1;
     }
 
+    Nom_PathInvalidate(Path);
+    Nom_PathInvalidate(NewPath);
+
     return 0;
 }
 
-int Nom_Readdir(const char* Path, char** Buffer) {
-    #ifdef _WIN32
-            HANDLE FileHandle = NULL;
-            WIN32_FIND_DATA ffd;
+#define __NOM_DIR_OTHER 0
+#define __NOM_DIR_FILE 1
+#define __NOM_DIR_DIR 2
 
-            const char* DirPath = PATH(Path, "*");
-            FileHandle = FindFirstFile(DirPath, &ffd);
+char* __Nom_NameCopy(const char* Name) {
+    u32 Length = strlen(Name);
+    char* Copy = NOM_ALLOC(Length + 1);
+    memcpy(Copy, Name, Length + 1);
 
-            if (FileHandle == INVALID_HANDLE_VALUE) {
-                NOM_ERROR("Unable to Access Dir: %s Error: %lu", Path, GetLastError());
-                return -1;
-            }
+    return Copy;
+}
 
-            i32 i = 0;
+// Returns the path table entry of a directory with its listing read, or NULL if it can't be opened.
+Nom_PathEntry* __Nom_PathList(const char* Path) {
+    Nom_PathId Id = Nom_PathIntern(Path);
+    Nom_PathEntry* Entry = &__Nom_Paths.Items[Id];
 
-            do {
-                if (Buffer[i] != NULL) {
-                    free(Buffer[i]);
-                }
+    if (Entry->Listed) return Entry;
 
-                Buffer[i] = NOM_ALLOC(256);
-                memcpy(Buffer[i], ffd.cFileName, strlen(ffd.cFileName));
+    struct {
+        char** Items;
+        u32 Count;
+        u32 Size;
+    } Names = {0};
 
-                i += 1;
-            } while (FindNextFile(FileHandle, &ffd));
+    struct {
+        u8* Items;
+        u32 Count;
+        u32 Size;
+    } Kinds = {0};
 
-            FindClose(FileHandle);
-    #else
-        DIR* dir;
-        struct dirent* ent;
+    #ifdef _WIN32
+        WIN32_FIND_DATA ffd;
+
+        char* DirPath = (char*)PATH(Path, "*");
+        HANDLE FileHandle = FindFirstFile(DirPath, &ffd);
+        NOM_FREE(DirPath);
+
+        if (FileHandle == INVALID_HANDLE_VALUE) {
+            NOM_ERROR("Unable to Access Dir: %s Error: %lu", Path, GetLastError());
+            return NULL;
+        }
+
+        do {
+            u8 Kind = (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? __NOM_DIR_DIR : __NOM_DIR_FILE;
 
-        dir = opendir(Path);
+            DA_APPEND(&Names, __Nom_NameCopy(ffd.cFileName));
+            DA_APPEND(&Kinds, Kind);
+        } while (FindNextFile(FileHandle, &ffd));
+
+        FindClose(FileHandle);
+    #else
+        DIR* dir = opendir(Path);
 
         if (dir == NULL) {
             NOM_ERROR("Unable to Open Dir: %s Error: %s", Path, strerror(errno));
-            return -1;
+            return NULL;
         }
 
-        i32 i = 0;
-        ent = readdir(dir);
-        while (ent != NULL) {
-            if (Buffer != NULL) {
-                free(Buffer[i]);
-            }
+        struct dirent* ent;
+        while ((ent = readdir(dir)) != NULL) {
+            u8 Kind = __NOM_DIR_OTHER;
 
-            Buffer[i] = NOM_ALLOC(256);
-            memcpy(Buffer[i], ent->d_name, strlen(ent->d_name));
+            if (ent->d_type == DT_REG) Kind = __NOM_DIR_FILE;
+            if (ent->d_type == DT_DIR) Kind = __NOM_DIR_DIR;
 
-            ent = readdir(dir);
-            i += 1;
+            DA_APPEND(&Names, __Nom_NameCopy(ent->d_name));
+            DA_APPEND(&Kinds, Kind);
         }
 
         closedir(dir);
     #endif
 
-    return 0;
+    // Interning Path may have grown the table.
+    Entry = &__Nom_Paths.Items[Id];
+    Entry->Listed = true;
+    Entry->NameCount = Names.Count;
+    Entry->Names = Names.Items;
+    Entry->Kinds = Kinds.Items;
+
+    return Entry;
 }
 
-int Nom_GetDirFiles(const char* Path, char** Buffer) {
-    #ifdef _WIN32
-        HANDLE FileHandle = NULL;
-        WIN32_FIND_DATA ffd;
-
-        const char* DirPath = PATH(Path, "*");
-        FileHandle = FindFirstFile(DirPath, &ffd);
-
-        if (FileHandle == INVALID_HANDLE_VALUE) {
-            NOM_ERROR("Unable to Access Dir: %s Error: %s", Path, strerror(errno));
-            return -1;
-        }
-
-        i32 i = 0;
-
-        do {
-            if (!(ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-                if (Buffer[i] != NULL) {
-                    free(Buffer);
-                }
-
-                Buffer[i] = NOM_ALLOC(256);
-                memcpy(Buffer[i], ffd.cFileName, strlen(ffd.cFileName));
-
-                i += 1;
-            }
-        } while (FindNextFile(FileHandle, &ffd));
-
-        FindClose(FileHandle);
-    #else
-        DIR* dir;
-        struct dirent* ent;
-
-        dir = opendir(Path);
-
-        if (dir == NULL) {
-            NOM_ERROR("Unable to Open Dir: %s Error: %s", Path, strerror(errno));
-            return -1;
-        }
-
-        i32 i = 0;
-        ent = readdir(dir);
-        while (ent != NULL) {
-            if (ent->d_type == DT_REG) {
-                if (Buffer[i] != NULL) {
-                    free(Buffer);
-                }
+// Copies the names of Kind (or every name for __NOM_DIR_OTHER) into Buffer, freeing what it held.
+int __Nom_DirCopy(const char* Path, char** Buffer, u8 Kind) {
+    Nom_PathEntry* Entry = __Nom_PathList(Path);
+    if (Entry == NULL) return -1;
 
-                Buffer[i] = NOM_ALLOC(256);
-                memcpy(Buffer[i], ent->d_name, strlen(ent->d_name));
+    u32 o = 0;
 
-                i += 1;
-            }
+    for (u32 i = 0; i < Entry->NameCount; i++) {
+        if (Kind != __NOM_DIR_OTHER && Entry->Kinds[i] != Kind) continue;
 
-            ent = readdir(dir);
-        }
+        NOM_FREE(Buffer[o]);
+        Buffer[o] = NOM_ALLOC(256);
+        snprintf(Buffer[o], 256, "%s", Entry->Names[i]);
 
-        closedir(dir);
-    #endif
+        o += 1;
+    }
 
     return 0;
 }
 
-int Nom_GetDirDirs(const char* Path, char** Buffer) {
-    #ifdef _WIN32
-        HANDLE FileHandle = NULL;
-        WIN32_FIND_DATA ffd;
-
-        const char* DirPath = PATH(Path, "*");
-        FileHandle = FindFirstFile(DirPath, &ffd);
-
-        if (FileHandle == INVALID_HANDLE_VALUE) {
-            NOM_ERROR("Unable to Access Dir: %s Error: %s", Path, strerror(errno));
-            return -1;
-        }
-
-        i32 i = 0;
-
-        do {
-            if ((ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
-                if (Buffer[i] != NULL) {
-                    free(Buffer);
-                }
-
-                Buffer[i] = NOM_ALLOC(256);
-                memcpy(Buffer[i], ffd.cFileName, strlen(ffd.cFileName));
-
-                i += 1;
-            }
-        } while (FindNextFile(FileHandle, &ffd));
-
-        FindClose(FileHandle);
-    #else
-        DIR* dir;
-        struct dirent* ent;
-
-        dir = opendir(Path);
-
-        if (dir == NULL) {
-            NOM_ERROR("Unable to Open Dir: %s Error: %s", Path, strerror(errno));
-            return -1;
-        }
-
-        i32 i = 0;
-        ent = readdir(dir);
-        while (ent != NULL) {
-            if (ent->d_type == DT_DIR) {
-                if (Buffer[i] != NULL) {
-                    free(Buffer);
-                }
-
-                Buffer[i] = NOM_ALLOC(256);
-                memcpy(Buffer[i], ent->d_name, strlen(ent->d_name));
-                i += 1;
-            }
-
-            ent = readdir(dir);
-        }
+int Nom_Readdir(const char* Path, char** Buffer) {
+    return __Nom_DirCopy(Path, Buffer, __NOM_DIR_OTHER);
+}
 
-        closedir(dir);
-    #endif
+int Nom_GetDirFiles(const char* Path, char** Buffer) {
+    return __Nom_DirCopy(Path, Buffer, __NOM_DIR_FILE);
+}
 
-    return 0;
+int Nom_GetDirDirs(const char* Path, char** Buffer) {
+    return __Nom_DirCopy(Path, Buffer, __NOM_DIR_DIR);
 }
 
 int Nom_ReadFile(const char* Path, char* Buffer) {
@@ -533,15 +1017,35 @@ int Nom_WriteFile(const char* Path, const char* Buffer, _Bool Append) {
     fwrite(Buffer, sizeof (char), Lenght, file);
     fclose(file);
 
+    Nom_PathInvalidate(Path);
+
     return 0;
 }
 
 _Bool Nom_Exist(const char* Path) {
-    if (access(Path, F_OK) == 0) {
-        return true;
-    } else {
-        return false;
-    }
+    return Nom_PathStat(Nom_PathIntern(Path), NULL);
+}
+
+_Bool Nom_IsDir(const char* Path) {
+    struct stat Stat;
+
+    if (!Nom_PathStat(Nom_PathIntern(Path), &Stat)) return false;
+    return S_ISDIR(Stat.st_mode);
+}
+
+// Only meaningful compared against other Nom_Mtime values, returns -1 if Path does not exist.
+i64 Nom_Mtime(const char* Path) {
+    struct stat Stat;
+
+    if (!Nom_PathStat(Nom_PathIntern(Path), &Stat)) return -1;
+
+    #if defined(__linux__)
+        return (i64)Stat.st_mtim.tv_sec * 1000000000 + Stat.st_mtim.tv_nsec;
+    #elif defined(__APPLE__)
+        return (i64)Stat.st_mtimespec.tv_sec * 1000000000 + Stat.st_mtimespec.tv_nsec;
+    #else
+        return (i64)Stat.st_mtime;
+    #endif
 }
 
 // ------------------------------------------
@@ -625,63 +1129,112 @@ void Nom_ShowCmd(Nom_Cmd cmd, Nom_SB* sb) {
     SB_APPEND_NULL(sb);
 }
 
-Pid Nom_CmdRun_Async(Nom_Cmd cmd) {
-    Nom_SB sb = {0};
+void __Nom_CmdInvalidateOutput(Nom_Cmd cmd) {
+    for (u32 i = 0; i + 1 < cmd.Count; i++) {
+        if (strcmp(cmd.Items[i], "-o") == 0) {
+            Nom_PathInvalidate(cmd.Items[i + 1]);
+        }
+    }
+}
 
-    Nom_ShowCmd(cmd, &sb);
-    NOM_INFO("Running Cmd: %s", sb.Items);
+typedef struct {
+    Pid Proc;
+    Nom_PathId Output;
+} __Nom_ProcOutput;
+
+// The -o outputs of commands that have not been waited on yet, they are invalidated once more when
+// the command finishes as anything statted while it ran is stale by then.
+struct {
+    __Nom_ProcOutput* Items;
+    u32 Count;
+    u32 Size;
+} __Nom_ProcOutputs = {0};
 
-    #ifdef _WIN32
-        STARTUPINFO StartUpInfo;
-        ZeroMemory(&StartUpInfo, sizeof(StartUpInfo));
-        StartUpInfo.cb = sizeof(STARTUPINFO);
-        
-        StartUpInfo.hStdError = GetStdHandle(STD_ERROR_HANDLE);
-        StartUpInfo.hStdOutput = GetStdHandle(STD_OUTPUT_HANDLE);
-        StartUpInfo.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
-        StartUpInfo.dwFlags |= STARTF_USESTDHANDLES;
+void __Nom_ProcTrack(Pid proc, Nom_Cmd cmd) {
+    if (proc == NOM_INVALID_PID) return;
 
-        PROCESS_INFORMATION ProcessInfo;
-        ZeroMemory(&ProcessInfo, sizeof(PROCESS_INFORMATION));
+    for (u32 i = 0; i + 1 < cmd.Count; i++) {
+        if (strcmp(cmd.Items[i], "-o") == 0) {
+            __Nom_ProcOutput Output = { proc, Nom_PathIntern(cmd.Items[i + 1]) };
+            DA_APPEND(&__Nom_ProcOutputs, Output);
+        }
+    }
+}
 
-        BOOL ProcCreate = CreateProcessA(
-            NULL,
-            sb.Items,
-            NULL, NULL, TRUE, 0, NULL, NULL,
-            &StartUpInfo,
-            &ProcessInfo
-        );
+#ifdef _WIN32
+    typedef struct {
+        Pid Proc;
+        HANDLE Job;
+    } __Nom_ProcJob;
+
+    struct {
+        __Nom_ProcJob* Items;
+        u32 Count;
+        u32 Size;
+    } __Nom_ProcJobs = {0};
+
+    HANDLE __Nom_ProcJobFind(Pid proc, _Bool Remove) {
+        for (u32 i = 0; i < __Nom_ProcJobs.Count; i++) {
+            if (__Nom_ProcJobs.Items[i].Proc != proc) continue;
+
+            HANDLE Job = __Nom_ProcJobs.Items[i].Job;
+
+            if (Remove) {
+                __Nom_ProcJobs.Count -= 1;
+                __Nom_ProcJobs.Items[i] = __Nom_ProcJobs.Items[__Nom_ProcJobs.Count];
+            }
 
-        if (!ProcCreate) {
-            NOM_ERROR("Could not create child process: %lu", GetLastError());
-            return NOM_INVALID_PID;
+            return Job;
         }
 
-        CloseHandle(ProcessInfo.hThread);
+        return NULL;
+    }
+#endif
 
-        return ProcessInfo.hProcess;
-    #else
-        Pid ChildPid = fork();
+void __Nom_ProcDone(Pid proc) {
+    #ifdef _WIN32
+        HANDLE Job = __Nom_ProcJobFind(proc, true);
+        if (Job != NULL) CloseHandle(Job);
+    #endif
 
-        if (ChildPid < 0) {
-            NOM_ERROR("Failed to fork child process: %s", strerror(errno));
-            return NOM_INVALID_PID;
+    u32 i = 0;
+
+    while (i < __Nom_ProcOutputs.Count) {
+        if (__Nom_ProcOutputs.Items[i].Proc != proc) {
+            i += 1;
+            continue;
         }
 
-        if (ChildPid == 0) {
-            if (execvp(cmd.Items[0], (char* const*)cmd.Items) < 0) {
-                NOM_ERROR("Failed to run child process: %i, Error: %s", ChildPid, strerror(errno));
-                exit(126);
-            }
+        // The path table may have been freed and refilled since, an extra invalidation is harmless.
+        if (__Nom_ProcOutputs.Items[i].Output < __Nom_Paths.Count) {
+            Nom_PathInvalidate(Nom_PathStr(__Nom_ProcOutputs.Items[i].Output));
         }
 
-        return ChildPid;
-    #endif
+        __Nom_ProcOutputs.Count -= 1;
+        __Nom_ProcOutputs.Items[i] = __Nom_ProcOutputs.Items[__Nom_ProcOutputs.Count];
+    }
+}
+
+Pid Nom_CmdRun_Async(Nom_Cmd cmd) {
+    Nom_SB sb = {0};
+
+    __Nom_CmdInvalidateOutput(cmd);
+
+    Nom_ShowCmd(cmd, &sb);
+    NOM_INFO("Running Cmd: %s", sb.Items);
+    Nom_FreeSB(&sb);
+
+    Pid proc = __Nom_SpawnRedirect(cmd, NULL);
+    __Nom_ProcTrack(proc, cmd);
+
+    return proc;
 }
 
 int Nom_CmdRun_Sync(Nom_Cmd cmd) {
     Pid proc = Nom_CmdRun_Async(cmd);
-    if (Nom_Wait(proc) < 0) {
+    int Result = Nom_Wait(proc);
+
+    if (Result < 0) {
         return -1;
     }
 
@@ -699,6 +1252,8 @@ int Nom_Wait(Pid proc) {
             return -1;
         }
 
+        __Nom_ProcDone(proc);
+
         DWORD exit_status;
         if (!GetExitCodeProcess(proc, &exit_status)) {
             NOM_ERROR("could not get process exit code: %lu", GetLastError());
@@ -721,6 +1276,8 @@ int Nom_Wait(Pid proc) {
                 return -1;
             }
 
+            if (WIFEXITED(wstatus) || WIFSIGNALED(wstatus)) __Nom_ProcDone(proc);
+
             if (WIFEXITED(wstatus)) {
                 ExitStatus = WEXITSTATUS(wstatus);
 
@@ -742,16 +1299,2580 @@ int Nom_Wait(Pid proc) {
     return 0;
 }
 
-void Nom_FreeSB(Nom_SB* sb) {
-    NOM_FREE(sb->Items);
-    sb->Count = 0;
-    sb->Size = 0;
+Pid __Nom_SpawnRedirect(Nom_Cmd cmd, const char* OutPath) {
+    #ifdef _WIN32
+        Nom_SB sb = {0};
+        Nom_ShowCmd(cmd, &sb);
+
+        SECURITY_ATTRIBUTES Attributes = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+        HANDLE Out = GetStdHandle(STD_OUTPUT_HANDLE);
+        HANDLE Err = GetStdHandle(STD_ERROR_HANDLE);
+
+        if (OutPath != NULL) {
+            Out = CreateFileA(OutPath, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, &Attributes, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+
+            if (Out == INVALID_HANDLE_VALUE) {
+                NOM_ERROR("Unable to Open File: %s Error: %lu", OutPath, GetLastError());
+                Nom_FreeSB(&sb);
+                return NOM_INVALID_PID;
+            }
+
+            Err = Out;
+        }
+
+        STARTUPINFO StartUpInfo;
+        ZeroMemory(&StartUpInfo, sizeof(StartUpInfo));
+        StartUpInfo.cb = sizeof(STARTUPINFO);
+
+        StartUpInfo.hStdError = Err;
+        StartUpInfo.hStdOutput = Out;
+        StartUpInfo.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+        StartUpInfo.dwFlags |= STARTF_USESTDHANDLES;
+
+        PROCESS_INFORMATION ProcessInfo;
+        ZeroMemory(&ProcessInfo, sizeof(PROCESS_INFORMATION));
+
+        // The child starts suspended so it is in its Job Object before it can start anything.
+        BOOL ProcCreate = CreateProcessA(
+            NULL,
+            sb.Items,
+            NULL, NULL, TRUE, OutPath != NULL ? CREATE_SUSPENDED : 0, NULL, NULL,
+            &StartUpInfo,
+            &ProcessInfo
+        );
+
+        if (OutPath != NULL) CloseHandle(Out);
+        Nom_FreeSB(&sb);
+
+        if (!ProcCreate) {
+            NOM_ERROR("Could not create child process: %lu", GetLastError());
+            return NOM_INVALID_PID;
+        }
+
+        if (OutPath != NULL) {
+            HANDLE Job = CreateJobObjectA(NULL, NULL);
+
+            if (Job != NULL && AssignProcessToJobObject(Job, ProcessInfo.hProcess)) {
+                __Nom_ProcJob Entry = { ProcessInfo.hProcess, Job };
+                DA_APPEND(&__Nom_ProcJobs, Entry);
+            } else if (Job != NULL) {
+                CloseHandle(Job);
+            }
+
+            ResumeThread(ProcessInfo.hThread);
+        }
+
+        CloseHandle(ProcessInfo.hThread);
+
+        return ProcessInfo.hProcess;
+    #else
+        fflush(stdout);
+        Pid ChildPid = fork();
+
+        if (ChildPid < 0) {
+            NOM_ERROR("Failed to fork child process: %s", strerror(errno));
+            return NOM_INVALID_PID;
+        }
+
+        if (ChildPid == 0) {
+            if (OutPath != NULL) {
+                setpgid(0, 0);
+
+                int Fd = open(OutPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+                if (Fd < 0) exit(126);
+
+                dup2(Fd, STDOUT_FILENO);
+                dup2(Fd, STDERR_FILENO);
+                close(Fd);
+            }
+
+            // execvp needs a NULL terminated argv, cmd.Items has no room reserved for it.
+            char** Argv = NOM_ALLOC((cmd.Count + 1) * sizeof(char*));
+            memcpy(Argv, cmd.Items, cmd.Count * sizeof(char*));
+            Argv[cmd.Count] = NULL;
+
+            execvp(Argv[0], Argv);
+
+            NOM_ERROR("Failed to run child process: %s, Error: %s", Argv[0], strerror(errno));
+            exit(127);
+        }
+
+        // Also set from the parent so a __Nom_Kill right after the fork can not miss the group.
+        if (OutPath != NULL) setpgid(ChildPid, ChildPid);
+
+        return ChildPid;
+    #endif
 }
 
-void Nom_FreeCmd(Nom_Cmd* cmd) {
-    NOM_FREE(cmd->Items);
-    cmd->Count = 0;
-    cmd->Size = 0;
+// Unlike Nom_Wait this does not log, it returns the exit code or -1 if the process could not be waited on.
+int __Nom_WaitStatus(Pid proc) {
+    if (proc == NOM_INVALID_PID) return -1;
+
+    #ifdef _WIN32
+        DWORD Result = WaitForSingleObject(proc, INFINITE);
+        __Nom_ProcDone(proc);
+
+        if (Result == WAIT_FAILED) {
+            CloseHandle(proc);
+            return -1;
+        }
+
+        DWORD ExitStatus;
+        BOOL Ok = GetExitCodeProcess(proc, &ExitStatus);
+        CloseHandle(proc);
+
+        return Ok ? (int)ExitStatus : -1;
+    #else
+        i32 wstatus = 0;
+
+        while (waitpid(proc, &wstatus, 0) < 0) {
+            if (errno != EINTR) return -1;
+        }
+
+        __Nom_ProcDone(proc);
+
+        if (WIFEXITED(wstatus)) return WEXITSTATUS(wstatus);
+        return -1;
+    #endif
+}
+
+// Returns 1 and sets ExitCode once proc has finished (ExitCode is -1 if it was killed), 0 while it runs.
+int __Nom_TryWait(Pid proc, int* ExitCode) {
+    if (proc == NOM_INVALID_PID) {
+        *ExitCode = -1;
+        return 1;
+    }
+
+    #ifdef _WIN32
+        DWORD Result = WaitForSingleObject(proc, 0);
+        if (Result == WAIT_TIMEOUT) return 0;
+
+        __Nom_ProcDone(proc);
+
+        DWORD ExitStatus;
+        *ExitCode = Result == WAIT_OBJECT_0 && GetExitCodeProcess(proc, &ExitStatus) ? (int)ExitStatus : -1;
+        CloseHandle(proc);
+
+        return 1;
+    #else
+        i32 wstatus = 0;
+        Pid Result = waitpid(proc, &wstatus, WNOHANG);
+
+        if (Result == 0 || (Result < 0 && errno == EINTR)) return 0;
+
+        __Nom_ProcDone(proc);
+
+        *ExitCode = Result > 0 && WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : -1;
+        return 1;
+    #endif
+}
+
+void __Nom_Kill(Pid proc) {
+    if (proc == NOM_INVALID_PID) return;
+
+    #ifdef _WIN32
+        HANDLE Job = __Nom_ProcJobFind(proc, false);
+
+        if (Job == NULL || !TerminateJobObject(Job, 1)) {
+            TerminateProcess(proc, 1);
+        }
+    #else
+        // Only children with their own group (see __Nom_SpawnRedirect) have one to kill.
+        if (kill(-proc, SIGKILL) < 0) kill(proc, SIGKILL);
+    #endif
+}
+
+i64 __Nom_NowMs(void) {
+    #ifdef _WIN32
+        return (i64)GetTickCount64();
+    #else
+        struct timespec Now;
+        clock_gettime(CLOCK_MONOTONIC, &Now);
+
+        return (i64)Now.tv_sec * 1000 + Now.tv_nsec / 1000000;
+    #endif
+}
+
+void __Nom_SleepMs(u32 Ms) {
+    #ifdef _WIN32
+        Sleep(Ms);
+    #else
+        struct timespec Duration = { Ms / 1000, (Ms % 1000) * 1000000 };
+        nanosleep(&Duration, NULL);
+    #endif
+}
+
+void Nom_FreeSB(Nom_SB* sb) {
+    NOM_FREE(sb->Items);
+    sb->Count = 0;
+    sb->Size = 0;
+}
+
+void Nom_FreeCmd(Nom_Cmd* cmd) {
+    NOM_FREE(cmd->Items);
+    cmd->Count = 0;
+    cmd->Size = 0;
+}
+
+
+// ------------------------------------------
+// ----------------- REMOTE -----------------
+// ------------------------------------------
+
+#define NOM_REMOTE_MAGIC 0x4E4F4D31
+#define NOM_REMOTE_READY 0
+#define NOM_REMOTE_BUSY 1
+#define NOM_REMOTE_OK 0
+#define NOM_REMOTE_FAILED 1
+#define NOM_REMOTE_REJECTED 2
+#define NOM_REMOTE_MAX_BLOB (1u << 30)
+
+void __Nom_WorkersAppend(Nom_Workers* workers, ...) {
+    va_list args;
+    VA_ARGS_FOREACH(args, Address, const char*, workers, {
+        DA_APPEND(workers, Address);
+    })
+}
+
+void Nom_FreeWorkers(Nom_Workers* workers) {
+    NOM_FREE(workers->Items);
+    workers->Count = 0;
+    workers->Size = 0;
+}
+
+// Transfers use a small LZ77 scheme: a control byte below 0x80 is followed by (ctrl + 1) literal
+// bytes, otherwise it copies ((ctrl & 0x7F) + 4) bytes from a 16 bit offset back in the output.
+#define NOM_COMPRESS_BOUND(len) ((len) + (len) / 128 + 16)
+
+u32 __Nom_CompressLiterals(const u8* In, u32 Length, u8* Out) {
+    u32 o = 0;
+
+    while (Length > 0) {
+        u32 Count = Length > 128 ? 128 : Length;
+
+        Out[o++] = Count - 1;
+        memcpy(Out + o, In, Count);
+
+        o += Count;
+        In += Count;
+        Length -= Count;
+    }
+
+    return o;
+}
+
+u32 __Nom_Compress(const u8* In, u32 Length, u8* Out) {
+    u32 Table[4096] = {0};
+    u32 i = 0, Literal = 0, o = 0;
+
+    while (i + 4 <= Length) {
+        u32 Seq;
+        memcpy(&Seq, In + i, 4);
+
+        u32 Hash = (Seq * 2654435761u) >> 20;
+        u32 Candidate = Table[Hash];
+        Table[Hash] = i + 1;
+
+        if (Candidate == 0 || i + 1 - Candidate > 65535 || memcmp(In + Candidate - 1, In + i, 4) != 0) {
+            i += 1;
+            continue;
+        }
+
+        Candidate -= 1;
+        o += __Nom_CompressLiterals(In + Literal, i - Literal, Out + o);
+
+        u32 Len = 4;
+        while (i + Len < Length && Len < 131 && In[Candidate + Len] == In[i + Len]) Len += 1;
+
+        u32 Offset = i - Candidate;
+        Out[o++] = 0x80 | (Len - 4);
+        Out[o++] = Offset & 0xFF;
+        Out[o++] = Offset >> 8;
+
+        i += Len;
+        Literal = i;
+    }
+
+    o += __Nom_CompressLiterals(In + Literal, Length - Literal, Out + o);
+
+    return o;
+}
+
+int __Nom_Decompress(const u8* In, u32 Length, u8* Out, u32 OutLength) {
+    u32 i = 0, o = 0;
+
+    while (i < Length) {
+        u8 Ctrl = In[i++];
+
+        if (Ctrl < 0x80) {
+            u32 Count = Ctrl + 1;
+            if (i + Count > Length || o + Count > OutLength) return -1;
+
+            memcpy(Out + o, In + i, Count);
+            i += Count;
+            o += Count;
+        } else {
+            if (i + 2 > Length) return -1;
+
+            u32 Len = (Ctrl & 0x7F) + 4;
+            u32 Offset = In[i] | (In[i + 1] << 8);
+            i += 2;
+
+            if (Offset == 0 || Offset > o || o + Len > OutLength) return -1;
+
+            for (u32 j = 0; j < Len; j++) {
+                Out[o] = Out[o - Offset];
+                o += 1;
+            }
+        }
+    }
+
+    return o == OutLength ? 0 : -1;
+}
+
+int __Nom_ReadAll(const char* Path, u8** Data, u32* Length) {
+    #ifdef _WIN32
+        FILE* file = Nom_FOpen(Path, "rb");
+        if (file == NULL) return -1;
+
+        fseek(file, 0, SEEK_END);
+        long Size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        if (Size < 0) {
+            fclose(file);
+            return -1;
+        }
+
+        *Data = NOM_ALLOC(Size + 1);
+        *Length = fread(*Data, 1, Size, file);
+        (*Data)[*Length] = '\0';
+
+        fclose(file);
+    #else
+        // Plain read(2) as the include scanner calls this for every header.
+        int Fd = open(Path, O_RDONLY);
+        if (Fd < 0) return -1;
+
+        struct stat Stat;
+
+        if (fstat(Fd, &Stat) < 0) {
+            close(Fd);
+            return -1;
+        }
+
+        *Data = NOM_ALLOC(Stat.st_size + 1);
+        *Length = 0;
+
+        while (*Length < (u32)Stat.st_size) {
+            ssize_t n = read(Fd, *Data + *Length, Stat.st_size - *Length);
+
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+
+            *Length += n;
+        }
+
+        (*Data)[*Length] = '\0';
+        close(Fd);
+    #endif
+
+    return 0;
+}
+
+int __Nom_WriteAll(const char* Path, const u8* Data, u32 Length) {
+    FILE* file = Nom_FOpen(Path, "wb");
+
+    if (file == NULL) {
+        NOM_ERROR("Unable to Write File: %s Error: %s", Path, strerror(errno));
+        return -1;
+    }
+
+    u32 Written = fwrite(Data, 1, Length, file);
+    fclose(file);
+
+    Nom_PathInvalidate(Path);
+
+    return Written == Length ? 0 : -1;
+}
+
+_Bool __Nom_IsSource(const char* Arg) {
+    const char* Ext = strrchr(Arg, '.');
+    if (Ext == NULL) return false;
+
+    return strcmp(Ext, ".c") == 0 || strcmp(Ext, ".cc") == 0 || strcmp(Ext, ".cpp") == 0 ||
+           strcmp(Ext, ".cxx") == 0 || strcmp(Ext, ".c++") == 0 || strcmp(Ext, ".C") == 0;
+}
+
+#ifndef _WIN32
+    int __Nom_SendAll(int Fd, const void* Data, u32 Length) {
+        const u8* Bytes = Data;
+
+        while (Length > 0) {
+            ssize_t n = write(Fd, Bytes, Length);
+
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+
+            Bytes += n;
+            Length -= n;
+        }
+
+        return 0;
+    }
+
+    int __Nom_RecvAll(int Fd, void* Data, u32 Length) {
+        u8* Bytes = Data;
+
+        while (Length > 0) {
+            ssize_t n = read(Fd, Bytes, Length);
+
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+
+            if (n == 0) return -1;
+
+            Bytes += n;
+            Length -= n;
+        }
+
+        return 0;
+    }
+
+    int __Nom_SendU32(int Fd, u32 Value) {
+        u32 Net = htonl(Value);
+        return __Nom_SendAll(Fd, &Net, sizeof(Net));
+    }
+
+    int __Nom_RecvU32(int Fd, u32* Value) {
+        u32 Net;
+        if (__Nom_RecvAll(Fd, &Net, sizeof(Net)) < 0) return -1;
+
+        *Value = ntohl(Net);
+        return 0;
+    }
+
+    int __Nom_SendStr(int Fd, const char* Str) {
+        u32 Length = strlen(Str);
+        if (__Nom_SendU32(Fd, Length) < 0) return -1;
+
+        return __Nom_SendAll(Fd, Str, Length);
+    }
+
+    char* __Nom_RecvStr(int Fd) {
+        u32 Length;
+        if (__Nom_RecvU32(Fd, &Length) < 0 || Length > 65536) return NULL;
+
+        char* Str = NOM_ALLOC(Length + 1);
+
+        if (__Nom_RecvAll(Fd, Str, Length) < 0) {
+            NOM_FREE(Str);
+            return NULL;
+        }
+
+        Str[Length] = '\0';
+        return Str;
+    }
+
+    int __Nom_SendBlob(int Fd, const u8* Data, u32 Length) {
+        u8* Packed = NOM_ALLOC(NOM_COMPRESS_BOUND(Length));
+        u32 PackedLength = __Nom_Compress(Data, Length, Packed);
+
+        int Result = -1;
+        if (__Nom_SendU32(Fd, Length) == 0 && __Nom_SendU32(Fd, PackedLength) == 0) {
+            Result = __Nom_SendAll(Fd, Packed, PackedLength);
+        }
+
+        NOM_FREE(Packed);
+        return Result;
+    }
+
+    int __Nom_RecvBlob(int Fd, u8** Data, u32* Length) {
+        u32 PackedLength;
+
+        if (__Nom_RecvU32(Fd, Length) < 0 || __Nom_RecvU32(Fd, &PackedLength) < 0) return -1;
+        if (*Length > NOM_REMOTE_MAX_BLOB || PackedLength > NOM_COMPRESS_BOUND(*Length)) return -1;
+
+        u8* Packed = NOM_ALLOC(PackedLength + 1);
+        *Data = NOM_ALLOC(*Length + 1);
+
+        if (__Nom_RecvAll(Fd, Packed, PackedLength) < 0 || __Nom_Decompress(Packed, PackedLength, *Data, *Length) < 0) {
+            NOM_FREE(Packed);
+            NOM_FREE(*Data);
+            *Data = NULL;
+            return -1;
+        }
+
+        NOM_FREE(Packed);
+        return 0;
+    }
+
+    int __Nom_Socket(const char* Address, _Bool Server) {
+        if (strncmp(Address, "unix:", 5) == 0) {
+            struct sockaddr_un Addr = {0};
+            Addr.sun_family = AF_UNIX;
+
+            if (strlen(Address + 5) >= sizeof(Addr.sun_path)) {
+                NOM_ERROR("Socket path too long: %s", Address + 5);
+                return -1;
+            }
+
+            strcpy(Addr.sun_path, Address + 5);
+
+            int Fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (Fd < 0) return -1;
+
+            if (Server) {
+                unlink(Addr.sun_path);
+
+                if (bind(Fd, (struct sockaddr*)&Addr, sizeof(Addr)) < 0 || listen(Fd, 64) < 0) {
+                    NOM_ERROR("Unable to Listen on: %s Error: %s", Address, strerror(errno));
+                    close(Fd);
+                    return -1;
+                }
+            } else if (connect(Fd, (struct sockaddr*)&Addr, sizeof(Addr)) < 0) {
+                close(Fd);
+                return -1;
+            }
+
+            return Fd;
+        }
+
+        const char* Colon = strrchr(Address, ':');
+
+        if (Colon == NULL) {
+            NOM_ERROR("Invalid worker address: %s", Address);
+            return -1;
+        }
+
+        char Host[256] = {0};
+        u32 HostLength = Colon - Address < 255 ? Colon - Address : 255;
+        memcpy(Host, Address, HostLength);
+
+        struct addrinfo Hints = {0};
+        struct addrinfo* Info = NULL;
+
+        Hints.ai_family = AF_UNSPEC;
+        Hints.ai_socktype = SOCK_STREAM;
+        Hints.ai_flags = Server ? AI_PASSIVE : 0;
+
+        if (getaddrinfo(HostLength > 0 ? Host : NULL, Colon + 1, &Hints, &Info) != 0) {
+            NOM_ERROR("Unable to Resolve: %s", Address);
+            return -1;
+        }
+
+        int Fd = -1;
+
+        for (struct addrinfo* it = Info; it != NULL; it = it->ai_next) {
+            Fd = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+            if (Fd < 0) continue;
+
+            if (Server) {
+                int On = 1;
+                setsockopt(Fd, SOL_SOCKET, SO_REUSEADDR, &On, sizeof(On));
+
+                if (bind(Fd, it->ai_addr, it->ai_addrlen) == 0 && listen(Fd, 64) == 0) break;
+            } else if (connect(Fd, it->ai_addr, it->ai_addrlen) == 0) {
+                break;
+            }
+
+            close(Fd);
+            Fd = -1;
+        }
+
+        freeaddrinfo(Info);
+
+        if (Fd < 0 && Server) {
+            NOM_ERROR("Unable to Listen on: %s Error: %s", Address, strerror(errno));
+        }
+
+        return Fd;
+    }
+
+    // Returns 0 when the object was received, 1 when the compile failed, 2 when the worker refused
+    // the command and -1 on a transport error.
+    int __Nom_RemoteSend(int Sock, Nom_Cmd cmd, u32 Src, u32 Out, const char* Ext, const u8* Source, u32 SourceLength) {
+        if (__Nom_SendU32(Sock, NOM_REMOTE_MAGIC) < 0 || __Nom_SendU32(Sock, cmd.Count) < 0) return -1;
+
+        for (u32 i = 0; i < cmd.Count; i++) {
+            if (__Nom_SendStr(Sock, cmd.Items[i]) < 0) return -1;
+        }
+
+        if (__Nom_SendU32(Sock, Src) < 0 || __Nom_SendU32(Sock, Out) < 0) return -1;
+        if (__Nom_SendStr(Sock, Ext) < 0 || __Nom_SendBlob(Sock, Source, SourceLength) < 0) return -1;
+
+        u32 Status;
+        u8* Log = NULL;
+        u8* Object = NULL;
+        u32 LogLength = 0, ObjectLength = 0;
+
+        if (__Nom_RecvU32(Sock, &Status) < 0 || __Nom_RecvBlob(Sock, &Log, &LogLength) < 0) return -1;
+
+        if (__Nom_RecvBlob(Sock, &Object, &ObjectLength) < 0) {
+            NOM_FREE(Log);
+            return -1;
+        }
+
+        fwrite(Log, 1, LogLength, stderr);
+
+        int Result = 1;
+        if (Status == NOM_REMOTE_OK && __Nom_WriteAll(cmd.Items[Out], Object, ObjectLength) == 0) {
+            Result = 0;
+        } else if (Status == NOM_REMOTE_REJECTED) {
+            Result = 2;
+        }
+
+        NOM_FREE(Log);
+        NOM_FREE(Object);
+
+        return Result;
+    }
+
+    // Runs in the forked child: preprocess locally, then hand the job to the first worker that
+    // accepts it, compiling locally if every worker is busy or unreachable.
+    int __Nom_RemoteJob(Nom_Workers workers, Nom_Cmd cmd, u32 Compile, u32 Src, u32 Out) {
+        signal(SIGPIPE, SIG_IGN);
+
+        const char* Ext = strcmp(strrchr(cmd.Items[Src], '.'), ".c") == 0 ? ".i" : ".ii";
+
+        char Preprocessed[] = "/tmp/nom-XXXXXX";
+        int Fd = mkstemp(Preprocessed);
+        if (Fd < 0) return 1;
+        close(Fd);
+
+        Nom_Cmd pp = {0};
+        for (u32 i = 0; i < cmd.Count; i++) DA_APPEND(&pp, cmd.Items[i]);
+
+        pp.Items[Compile] = "-E";
+        pp.Items[Out] = Preprocessed;
+
+        int Status = __Nom_WaitStatus(__Nom_SpawnRedirect(pp, NULL));
+        Nom_FreeCmd(&pp);
+
+        u8* Source = NULL;
+        u32 SourceLength = 0;
+
+        if (Status != 0 || __Nom_ReadAll(Preprocessed, &Source, &SourceLength) < 0) {
+            remove(Preprocessed);
+            return 1;
+        }
+
+        remove(Preprocessed);
+
+        u32 Start = (u32)getpid() % workers.Count;
+
+        for (u32 n = 0; n < workers.Count; n++) {
+            const char* Address = workers.Items[(Start + n) % workers.Count];
+
+            int Sock = __Nom_Socket(Address, false);
+            if (Sock < 0) continue;
+
+            u32 Ready = NOM_REMOTE_BUSY;
+            if (__Nom_RecvU32(Sock, &Ready) < 0 || Ready != NOM_REMOTE_READY) {
+                close(Sock);
+                continue;
+            }
+
+            int Result = __Nom_RemoteSend(Sock, cmd, Src, Out, Ext, Source, SourceLength);
+            close(Sock);
+
+            if (Result == 0 || Result == 1) {
+                NOM_FREE(Source);
+                return Result;
+            }
+
+            if (Result == 2) {
+                NOM_WARN("Worker %s refused the job for %s", Address, cmd.Items[Src]);
+            } else {
+                NOM_WARN("Lost connection to worker: %s", Address);
+            }
+        }
+
+        NOM_FREE(Source);
+        NOM_WARN("No worker available for %s, compiling locally", cmd.Items[Src]);
+
+        return __Nom_WaitStatus(__Nom_SpawnRedirect(cmd, NULL)) == 0 ? 0 : 1;
+    }
+
+    // Prefixes of the only flags a worker accepts next to -c, the source and its one -o. They change
+    // code generation or diagnostics; __Nom_WorkerDenied carves out the ones that write files or
+    // run programs.
+    const char* __Nom_WorkerAllowed[] = {
+        "-D", "-U", "-I", "-iquote", "-isystem", "-O", "-g", "-std=", "-ansi", "-W", "-w", "-pedantic",
+        "-f", "-m", "-pipe", "-pthread", "-nostdinc",
+    };
+
+    const char* __Nom_WorkerDenied[] = {
+        "-Wa,", "-Wl,", "-Wp,", "-fplugin", "-fpass-plugin", "-fdump-", "-fprofile", "-fauto-profile",
+        "-fopt-info", "-fcallgraph-info", "-fstack-usage", "-fcompare-debug", "-fmodule", "-fdiagnostics-format",
+        "-fsave-optimization-record", "-ftime-trace", "-fproc-stat-report", "-fcrash-diagnostics",
+        "-ftest-coverage", "-mllvm",
+    };
+
+    // Flags from __Nom_WorkerAllowed that may take their value as the next argument.
+    const char* __Nom_WorkerValued[] = { "-D", "-U", "-I", "-iquote", "-isystem" };
+
+    #define __NOM_COUNT(array) (sizeof(array) / sizeof(array[0]))
+
+    _Bool __Nom_WorkerMatch(const char* Arg, const char** Prefixes, u32 Count) {
+        for (u32 i = 0; i < Count; i++) {
+            if (strncmp(Arg, Prefixes[i], strlen(Prefixes[i])) == 0) return true;
+        }
+
+        return false;
+    }
+
+    // Returns NULL if the worker may run cmd, otherwise the argument it refuses.
+    const char* __Nom_WorkerCheck(Nom_Cmd cmd, u32 Src, u32 Out, const char** Compilers, u32 CompilerCount) {
+        _Bool Allowed = false;
+
+        for (u32 i = 0; i < CompilerCount; i++) {
+            if (strcmp(cmd.Items[0], Compilers[i]) == 0) Allowed = true;
+        }
+
+        if (!Allowed) return cmd.Items[0];
+        if (Out < 2 || strcmp(cmd.Items[Out - 1], "-o") != 0) return cmd.Items[Out];
+
+        for (u32 i = 1; i < cmd.Count; i++) {
+            const char* Arg = cmd.Items[i];
+
+            if (i == Src || i == Out || i == Out - 1 || strcmp(Arg, "-c") == 0) continue;
+
+            if (!__Nom_WorkerMatch(Arg, __Nom_WorkerAllowed, __NOM_COUNT(__Nom_WorkerAllowed)) ||
+                __Nom_WorkerMatch(Arg, __Nom_WorkerDenied, __NOM_COUNT(__Nom_WorkerDenied))) {
+                return Arg;
+            }
+
+            for (u32 v = 0; v < __NOM_COUNT(__Nom_WorkerValued); v++) {
+                if (strcmp(Arg, __Nom_WorkerValued[v]) == 0 && i + 1 < cmd.Count && i + 1 != Src && i + 1 != Out) i += 1;
+            }
+        }
+
+        return NULL;
+    }
+
+    #undef __NOM_COUNT
+
+    int __Nom_WorkerJob(int Client, const char** Compilers, u32 CompilerCount) {
+        if (__Nom_SendU32(Client, NOM_REMOTE_READY) < 0) return 1;
+
+        u32 Magic, Count;
+        if (__Nom_RecvU32(Client, &Magic) < 0 || Magic != NOM_REMOTE_MAGIC) return 1;
+        if (__Nom_RecvU32(Client, &Count) < 0 || Count == 0 || Count > 65536) return 1;
+
+        Nom_Cmd cmd = {0};
+
+        for (u32 i = 0; i < Count; i++) {
+            char* Arg = __Nom_RecvStr(Client);
+            if (Arg == NULL) return 1;
+
+            DA_APPEND(&cmd, Arg);
+        }
+
+        u32 Src, Out;
+        if (__Nom_RecvU32(Client, &Src) < 0 || __Nom_RecvU32(Client, &Out) < 0) return 1;
+        if (Src >= Count || Out >= Count) return 1;
+
+        char* Ext = __Nom_RecvStr(Client);
+        if (Ext == NULL || (strcmp(Ext, ".i") != 0 && strcmp(Ext, ".ii") != 0)) return 1;
+
+        u8* Source = NULL;
+        u32 SourceLength = 0;
+        if (__Nom_RecvBlob(Client, &Source, &SourceLength) < 0) return 1;
+
+        const char* Refused = __Nom_WorkerCheck(cmd, Src, Out, Compilers, CompilerCount);
+
+        if (Refused != NULL) {
+            char Reason[512];
+            u32 ReasonLength = snprintf(Reason, sizeof(Reason), "nom-worker: refusing to run with: %s\n", Refused);
+            if (ReasonLength >= sizeof(Reason)) ReasonLength = sizeof(Reason) - 1;
+
+            NOM_WARN("Refused job with: %s", Refused);
+
+            __Nom_SendU32(Client, NOM_REMOTE_REJECTED);
+            __Nom_SendBlob(Client, (const u8*)Reason, ReasonLength);
+            __Nom_SendBlob(Client, NULL, 0);
+
+            close(Client);
+            return 1;
+        }
+
+        char SourcePath[64];
+        char ObjectPath[] = "/tmp/nom-worker-XXXXXX.o";
+        char LogPath[] = "/tmp/nom-worker-XXXXXX";
+
+        snprintf(SourcePath, sizeof(SourcePath), "/tmp/nom-worker-XXXXXX%s", Ext);
+
+        int SourceFd = mkstemps(SourcePath, strlen(Ext));
+        int ObjectFd = mkstemps(ObjectPath, 2);
+        int LogFd = mkstemp(LogPath);
+
+        if (SourceFd < 0 || ObjectFd < 0 || LogFd < 0) {
+            NOM_ERROR("Unable to create temporary files: %s", strerror(errno));
+            return 1;
+        }
+
+        int Written = __Nom_SendAll(SourceFd, Source, SourceLength);
+
+        close(SourceFd);
+        close(ObjectFd);
+        close(LogFd);
+        NOM_FREE(Source);
+
+        cmd.Items[Src] = SourcePath;
+        cmd.Items[Out] = ObjectPath;
+
+        int Status = Written < 0 ? -1 : __Nom_WaitStatus(__Nom_SpawnRedirect(cmd, LogPath));
+
+        u8* Log = NULL;
+        u8* Object = NULL;
+        u32 LogLength = 0, ObjectLength = 0;
+
+        __Nom_ReadAll(LogPath, &Log, &LogLength);
+        if (Status == 0) __Nom_ReadAll(ObjectPath, &Object, &ObjectLength);
+
+        remove(SourcePath);
+        remove(ObjectPath);
+        remove(LogPath);
+
+        __Nom_SendU32(Client, Status == 0 ? NOM_REMOTE_OK : NOM_REMOTE_FAILED);
+        __Nom_SendBlob(Client, Log, LogLength);
+        __Nom_SendBlob(Client, Object, ObjectLength);
+
+        close(Client);
+
+        return 0;
+    }
+#endif
+
+Pid Nom_CmdRun_Remote(Nom_Workers workers, Nom_Cmd cmd) {
+    #ifdef _WIN32
+        return Nom_CmdRun_Async(cmd);
+    #else
+        i32 Compile = -1, Src = -1, Out = -1;
+
+        for (u32 i = 1; i < cmd.Count; i++) {
+            const char* Arg = cmd.Items[i];
+
+            if (strcmp(Arg, "-c") == 0) {
+                Compile = i;
+            } else if (strcmp(Arg, "-o") == 0 && i + 1 < cmd.Count) {
+                Out = i + 1;
+                i += 1;
+            } else if (strncmp(Arg, "-M", 2) == 0 || strncmp(Arg, "-x", 2) == 0) {
+                // Depfiles and explicit languages do not survive preprocessing on another host.
+                return Nom_CmdRun_Async(cmd);
+            } else if (Arg[0] != '-' && __Nom_IsSource(Arg)) {
+                if (Src >= 0) return Nom_CmdRun_Async(cmd);
+                Src = i;
+            }
+        }
+
+        if (workers.Count == 0 || Compile < 0 || Src < 0 || Out < 0) {
+            return Nom_CmdRun_Async(cmd);
+        }
+
+        Nom_SB sb = {0};
+
+        Nom_ShowCmd(cmd, &sb);
+        NOM_INFO("Running Cmd (remote): %s", sb.Items);
+        Nom_FreeSB(&sb);
+
+        __Nom_CmdInvalidateOutput(cmd);
+
+        fflush(stdout);
+        Pid ChildPid = fork();
+
+        if (ChildPid < 0) {
+            NOM_ERROR("Failed to fork child process: %s", strerror(errno));
+            return NOM_INVALID_PID;
+        }
+
+        if (ChildPid == 0) {
+            exit(__Nom_RemoteJob(workers, cmd, Compile, Src, Out));
+        }
+
+        __Nom_ProcTrack(ChildPid, cmd);
+
+        return ChildPid;
+    #endif
+}
+
+int Nom_WorkerServe(const char* Address, u32 MaxJobs, const char** Compilers, u32 CompilerCount) {
+    #ifdef _WIN32
+        NOM_ERROR("Remote workers are not supported on Windows");
+        return -1;
+    #else
+        if (CompilerCount == 0) {
+            NOM_ERROR("Worker needs at least one allowed compiler");
+            return -1;
+        }
+
+        int Listener = __Nom_Socket(Address, true);
+        if (Listener < 0) return -1;
+
+        if (MaxJobs == 0) MaxJobs = NOM_WORKER_JOBS;
+        signal(SIGPIPE, SIG_IGN);
+
+        NOM_INFO("Worker listening on %s with %u jobs", Address, MaxJobs);
+
+        u32 Active = 0;
+
+        for (;;) {
+            int Client = accept(Listener, NULL, NULL);
+
+            if (Client < 0) {
+                if (errno == EINTR) continue;
+
+                NOM_ERROR("Unable to Accept on: %s Error: %s", Address, strerror(errno));
+                close(Listener);
+                return -1;
+            }
+
+            while (Active > 0 && waitpid(-1, NULL, WNOHANG) > 0) Active -= 1;
+
+            if (Active >= MaxJobs) {
+                __Nom_SendU32(Client, NOM_REMOTE_BUSY);
+                close(Client);
+                continue;
+            }
+
+            fflush(stdout);
+            Pid Child = fork();
+
+            if (Child == 0) {
+                close(Listener);
+                exit(__Nom_WorkerJob(Client, Compilers, CompilerCount));
+            }
+
+            close(Client);
+
+            if (Child < 0) {
+                NOM_ERROR("Failed to fork child process: %s", strerror(errno));
+            } else {
+                Active += 1;
+            }
+        }
+    #endif
+}
+
+// ------------------------------------------
+// ----------------- CHECKS -----------------
+// ------------------------------------------
+
+// Scratch files in NOM_CACHE_DIR carry the pid so nom processes sharing a tree do not collide.
+u32 __Nom_ProcessId(void) {
+    #ifdef _WIN32
+        return (u32)GetCurrentProcessId();
+    #else
+        return (u32)getpid();
+    #endif
+}
+
+// The cache file is one "<value>\t<key>" line per entry. Compilers are keyed by path, size and
+// mtime and map to a hash of their --version output, results are keyed by that hash.
+typedef struct {
+    char* Key;
+    u32 Value;
+} __Nom_CacheEntry;
+
+struct {
+    __Nom_CacheEntry* Items;
+    u32 Count;
+    u32 Size;
+
+    _Bool Loaded;
+    _Bool Dirty;
+} __Nom_CheckCache = {0};
+
+__Nom_CacheEntry* __Nom_CacheGet(const char* Key) {
+    for (u32 i = 0; i < __Nom_CheckCache.Count; i++) {
+        if (strcmp(__Nom_CheckCache.Items[i].Key, Key) == 0) return &__Nom_CheckCache.Items[i];
+    }
+
+    return NULL;
+}
+
+void __Nom_CacheSet(const char* Key, u32 Value) {
+    __Nom_CacheEntry* Entry = __Nom_CacheGet(Key);
+
+    if (Entry != NULL) {
+        Entry->Value = Value;
+    } else {
+        __Nom_CacheEntry New = { (char*)CONCAT(Key), Value };
+        DA_APPEND(&__Nom_CheckCache, New);
+    }
+
+    __Nom_CheckCache.Dirty = true;
+}
+
+// Adds the entries of the cache file whose key is not known yet, entries set by this process win.
+void __Nom_CacheRead(void) {
+    u8* Data = NULL;
+    u32 Length = 0;
+
+    const char* Path = PATH(NOM_CACHE_DIR, "checks");
+    int Result = __Nom_ReadAll(Path, &Data, &Length);
+    NOM_FREE((char*)Path);
+
+    if (Result < 0) return;
+
+    char* Line = (char*)Data;
+
+    while (*Line != '\0') {
+        char* End = strchr(Line, '\n');
+        if (End != NULL) *End = '\0';
+
+        char* Tab = NULL;
+        u32 Value = strtoul(Line, &Tab, 16);
+
+        if (Tab != NULL && *Tab == '\t' && __Nom_CacheGet(Tab + 1) == NULL) {
+            __Nom_CacheEntry Entry = { (char*)CONCAT(Tab + 1), Value };
+            DA_APPEND(&__Nom_CheckCache, Entry);
+        }
+
+        if (End == NULL) break;
+        Line = End + 1;
+    }
+
+    NOM_FREE(Data);
+}
+
+void __Nom_CacheLoad(void) {
+    if (__Nom_CheckCache.Loaded) return;
+    __Nom_CheckCache.Loaded = true;
+
+    __Nom_CacheRead();
+}
+
+// Other nom processes may have saved since the load, so their entries are merged in first. The
+// file is written under a per process name and moved over the cache, readers never see half of it.
+int __Nom_CacheSave(void) {
+    if (!__Nom_CheckCache.Dirty) return 0;
+
+    if (!Nom_IsDir(NOM_CACHE_DIR) && Nom_Mkdir(NOM_CACHE_DIR) < 0) return -1;
+
+    __Nom_CacheRead();
+
+    char Name[32];
+    snprintf(Name, sizeof(Name), "checks-%u.tmp", __Nom_ProcessId());
+
+    const char* Path = PATH(NOM_CACHE_DIR, "checks");
+    const char* TempPath = PATH(NOM_CACHE_DIR, Name);
+    FILE* file = Nom_FOpen(TempPath, "w");
+
+    if (file == NULL) {
+        NOM_ERROR("Unable to Write File: %s Error: %s", TempPath, strerror(errno));
+        NOM_FREE((char*)Path);
+        NOM_FREE((char*)TempPath);
+        return -1;
+    }
+
+    for (u32 i = 0; i < __Nom_CheckCache.Count; i++) {
+        fprintf(file, "%x\t%s\n", __Nom_CheckCache.Items[i].Value, __Nom_CheckCache.Items[i].Key);
+    }
+
+    _Bool Written = ferror(file) == 0;
+    Written = fclose(file) == 0 && Written;
+
+    #ifdef _WIN32
+        // rename does not replace an existing file on Windows.
+        if (Written && Nom_Exist(Path)) remove(Path);
+    #endif
+
+    int Result = Written ? Nom_Move(TempPath, Path) : -1;
+
+    if (Result < 0) {
+        if (!Written) NOM_ERROR("Unable to Write File: %s", TempPath);
+        remove(TempPath);
+        Nom_PathInvalidate(TempPath);
+    }
+
+    NOM_FREE((char*)Path);
+    NOM_FREE((char*)TempPath);
+
+    if (Result == 0) __Nom_CheckCache.Dirty = false;
+
+    return Result;
+}
+
+char* Nom_FindProgram(const char* Name) {
+    if (strchr(Name, '/') != NULL || strchr(Name, PATH_SEP) != NULL) {
+        return Nom_Exist(Name) ? (char*)CONCAT(Name) : NULL;
+    }
+
+    #ifdef _WIN32
+        const char ListSep = ';';
+        const char* Suffix = strstr(Name, ".exe") != NULL ? "" : ".exe";
+    #else
+        const char ListSep = ':';
+        const char* Suffix = "";
+    #endif
+
+    const char* Env = getenv("PATH");
+    if (Env == NULL) return NULL;
+
+    while (*Env != '\0') {
+        const char* End = strchr(Env, ListSep);
+        u32 Length = End != NULL ? (u32)(End - Env) : (u32)strlen(Env);
+
+        char Dir[4096] = ".";
+        if (Length > 0 && Length < sizeof(Dir)) {
+            memcpy(Dir, Env, Length);
+            Dir[Length] = '\0';
+        }
+
+        char Candidate[4096];
+        int Written = snprintf(Candidate, sizeof(Candidate), "%s%c%s%s", Dir, PATH_SEP, Name, Suffix);
+
+        if (Written < (int)sizeof(Candidate) && Nom_Exist(Candidate) && !Nom_IsDir(Candidate)) {
+            return (char*)CONCAT(Candidate);
+        }
+
+        if (End == NULL) break;
+        Env = End + 1;
+    }
+
+    return NULL;
+}
+
+// Returns a hash of the compiler's --version output, 0 if the compiler can not be found.
+u32 __Nom_CompilerVersion(const char* Compiler) {
+    char* Path = Nom_FindProgram(Compiler);
+
+    if (Path == NULL) {
+        NOM_WARN("Compiler not found: %s", Compiler);
+        return 0;
+    }
+
+    struct stat Stat;
+    Nom_PathStat(Nom_PathIntern(Path), &Stat);
+
+    char Size[32], Mtime[32];
+    snprintf(Size, sizeof(Size), "%lld", (long long)Stat.st_size);
+    snprintf(Mtime, sizeof(Mtime), "%lld", (long long)Nom_Mtime(Path));
+
+    const char* Key = CONCAT_SEP('\t', "C", Path, Size, Mtime);
+    __Nom_CacheEntry* Entry = __Nom_CacheGet(Key);
+
+    u32 Version = Entry != NULL ? Entry->Value : 0;
+
+    if (Entry == NULL) {
+        if (!Nom_IsDir(NOM_CACHE_DIR)) Nom_Mkdir(NOM_CACHE_DIR);
+
+        char Name[32];
+        snprintf(Name, sizeof(Name), "version-%u", __Nom_ProcessId());
+
+        const char* OutPath = PATH(NOM_CACHE_DIR, Name);
+
+        Nom_Cmd cmd = {0};
+        Nom_CmdAppend(&cmd, Path, "--version");
+        __Nom_WaitStatus(__Nom_SpawnRedirect(cmd, OutPath));
+        Nom_FreeCmd(&cmd);
+
+        u8* Output = NULL;
+        u32 OutputLength = 0;
+
+        if (__Nom_ReadAll(OutPath, &Output, &OutputLength) == 0) {
+            Version = __Nom_PathHash((char*)Output) | 1;
+            NOM_FREE(Output);
+        }
+
+        remove(OutPath);
+        NOM_FREE((char*)OutPath);
+
+        if (Version != 0) __Nom_CacheSet(Key, Version);
+    }
+
+    NOM_FREE((char*)Key);
+    NOM_FREE(Path);
+
+    return Version;
+}
+
+void __Nom_CheckAppend(Nom_Checks* checks, Nom_CheckKind Kind, const char* Compiler, const char* Arg, _Bool* Result) {
+    Nom_Check Check = { Kind, Compiler, Arg, Result };
+    DA_APPEND(checks, Check);
+}
+
+void Nom_CheckCompilerFlag(Nom_Checks* checks, const char* Compiler, const char* Flag, _Bool* Result) {
+    __Nom_CheckAppend(checks, NOM_CHECK_FLAG, Compiler, Flag, Result);
+}
+
+void Nom_CheckHeader(Nom_Checks* checks, const char* Compiler, const char* Header, _Bool* Result) {
+    __Nom_CheckAppend(checks, NOM_CHECK_HEADER, Compiler, Header, Result);
+}
+
+void Nom_CheckFunction(Nom_Checks* checks, const char* Compiler, const char* Function, _Bool* Result) {
+    __Nom_CheckAppend(checks, NOM_CHECK_FUNCTION, Compiler, Function, Result);
+}
+
+// C++ drivers (g++, clang++, c++, ...) get a .cc probe, clang++ warns about .c sources and
+// flag probes run with -Werror.
+_Bool __Nom_CompilerIsCxx(const char* Compiler) {
+    const char* Name = strrchr(Compiler, PATH_SEP);
+    Name = Name != NULL ? Name + 1 : Compiler;
+
+    #ifdef _WIN32
+        if (strrchr(Name, '/') != NULL) Name = strrchr(Name, '/') + 1;
+    #endif
+
+    return strstr(Name, "++") != NULL;
+}
+
+Pid __Nom_CheckSpawn(Nom_Check Check, u32 Index, Nom_Cmd* cmd) {
+    char Name[48];
+    const char* Ext = __Nom_CompilerIsCxx(Check.Compiler) ? "cc" : "c";
+
+    snprintf(Name, sizeof(Name), "probe-%u-%u.%s", __Nom_ProcessId(), Index, Ext);
+    const char* Source = PATH(NOM_CACHE_DIR, Name);
+
+    snprintf(Name, sizeof(Name), "probe-%u-%u.out", __Nom_ProcessId(), Index);
+    const char* Output = PATH(NOM_CACHE_DIR, Name);
+
+    Nom_SB sb = {0};
+
+    switch (Check.Kind) {
+        case NOM_CHECK_FLAG:
+            SB_APPEND_CSTR(&sb, "int main(void) { return 0; }\n");
+            break;
+        case NOM_CHECK_HEADER:
+            SB_APPEND_CSTR(&sb, "#include <", Check.Arg, ">\nint main(void) { return 0; }\n");
+            break;
+        case NOM_CHECK_FUNCTION:
+            SB_APPEND_CSTR(&sb, "#ifdef __cplusplus\nextern \"C\"\n#endif\nchar ", Check.Arg, "(void);\n");
+            SB_APPEND_CSTR(&sb, "int main(void) { return ", Check.Arg, "(); }\n");
+            break;
+    }
+
+    if (__Nom_WriteAll(Source, (const u8*)sb.Items, sb.Count) < 0) {
+        Nom_FreeSB(&sb);
+        NOM_FREE((char*)Source);
+        NOM_FREE((char*)Output);
+        return NOM_INVALID_PID;
+    }
+
+    Nom_FreeSB(&sb);
+
+    Nom_CmdAppend(cmd, Check.Compiler);
+
+    if (Check.Kind == NOM_CHECK_FLAG) {
+        Nom_CmdAppend(cmd, "-Werror");
+
+        const char* Flag = Check.Arg;
+
+        while (*Flag != '\0') {
+            while (*Flag == ' ') Flag += 1;
+
+            u32 Length = strcspn(Flag, " ");
+            if (Length == 0) break;
+
+            char* Item = NOM_ALLOC(Length + 1);
+            memcpy(Item, Flag, Length);
+            Item[Length] = '\0';
+
+            DA_APPEND(cmd, Item);
+            Flag += Length;
+        }
+    } else if (Check.Kind == NOM_CHECK_HEADER) {
+        Nom_CmdAppend(cmd, "-c");
+    }
+
+    Nom_CmdAppend(cmd, Source, "-o", Output);
+
+    #ifdef _WIN32
+        return __Nom_SpawnRedirect(*cmd, "NUL");
+    #else
+        return __Nom_SpawnRedirect(*cmd, "/dev/null");
+    #endif
+}
+
+void __Nom_CheckCleanup(Nom_Check Check, Nom_Cmd* cmd) {
+    if (Check.Kind == NOM_CHECK_FLAG) {
+        // Items between "-Werror" and the source are the flags split off Check.Arg.
+        for (u32 i = 2; i + 3 < cmd->Count; i++) NOM_FREE(cmd->Items[i]);
+    }
+
+    const char* Source = cmd->Items[cmd->Count - 3];
+    const char* Output = cmd->Items[cmd->Count - 1];
+
+    remove(Source);
+    remove(Output);
+    Nom_PathInvalidate(Output);
+
+    // Probes using -gsplit-dwarf also leave "<output>-<source name>.dwo" behind.
+    const char* Name = strrchr(Source, PATH_SEP) != NULL ? strrchr(Source, PATH_SEP) + 1 : Source;
+    char Dwo[512];
+
+    if (snprintf(Dwo, sizeof(Dwo), "%s-%.*s.dwo", Output, (int)(strrchr(Name, '.') - Name), Name) < (int)sizeof(Dwo)) {
+        remove(Dwo);
+    }
+
+    NOM_FREE((char*)Source);
+    NOM_FREE((char*)Output);
+    Nom_FreeCmd(cmd);
+}
+
+int Nom_CheckRun(Nom_Checks* checks) {
+    static const char* KindNames[] = { "flag", "header", "function" };
+
+    __Nom_CacheLoad();
+
+    u32* Pending = NOM_ALLOC((checks->Count + 1) * sizeof(u32));
+    char** Keys = NOM_ALLOC((checks->Count + 1) * sizeof(char*));
+    u32 PendingCount = 0;
+
+    const char* Compiler = NULL;
+    u32 Version = 0;
+
+    for (u32 i = 0; i < checks->Count; i++) {
+        Nom_Check Check = checks->Items[i];
+
+        Keys[i] = NULL;
+        *Check.Result = false;
+
+        if (Compiler == NULL || strcmp(Compiler, Check.Compiler) != 0) {
+            Compiler = Check.Compiler;
+            Version = __Nom_CompilerVersion(Compiler);
+        }
+
+        if (Version == 0) continue;
+
+        char VersionHex[16];
+        snprintf(VersionHex, sizeof(VersionHex), "%x", Version);
+
+        Keys[i] = (char*)CONCAT_SEP('\t', "R", VersionHex, KindNames[Check.Kind], Check.Arg);
+        __Nom_CacheEntry* Entry = __Nom_CacheGet(Keys[i]);
+
+        if (Entry != NULL) {
+            *Check.Result = Entry->Value != 0;
+        } else {
+            Pending[PendingCount++] = i;
+        }
+    }
+
+    if (PendingCount > 0 && !Nom_IsDir(NOM_CACHE_DIR) && Nom_Mkdir(NOM_CACHE_DIR) < 0) {
+        PendingCount = 0;
+    }
+
+    Pid Procs[NOM_CHECK_JOBS];
+    Nom_Cmd Cmds[NOM_CHECK_JOBS];
+
+    // Probes run NOM_CHECK_JOBS at a time and are reaped in the order they were started.
+    for (u32 Started = 0, Done = 0; Done < PendingCount;) {
+        if (Started < PendingCount && Started - Done < NOM_CHECK_JOBS) {
+            u32 Slot = Started % NOM_CHECK_JOBS;
+
+            memset(&Cmds[Slot], 0, sizeof(Nom_Cmd));
+            Procs[Slot] = __Nom_CheckSpawn(checks->Items[Pending[Started]], Started, &Cmds[Slot]);
+
+            Started += 1;
+            continue;
+        }
+
+        u32 Slot = Done % NOM_CHECK_JOBS;
+        u32 Index = Pending[Done];
+        _Bool Ran = Procs[Slot] != NOM_INVALID_PID && Cmds[Slot].Count > 0;
+        _Bool Passed = __Nom_WaitStatus(Procs[Slot]) == 0;
+
+        *checks->Items[Index].Result = Passed;
+
+        // A probe that could not be written or started says nothing about the compiler.
+        if (Ran) __Nom_CacheSet(Keys[Index], Passed);
+
+        if (Cmds[Slot].Count > 0) __Nom_CheckCleanup(checks->Items[Index], &Cmds[Slot]);
+
+        Done += 1;
+    }
+
+    for (u32 i = 0; i < checks->Count; i++) NOM_FREE(Keys[i]);
+    NOM_FREE(Keys);
+    NOM_FREE(Pending);
+
+    return __Nom_CacheSave();
+}
+
+void Nom_FreeChecks(Nom_Checks* checks) {
+    NOM_FREE(checks->Items);
+    checks->Count = 0;
+    checks->Size = 0;
+}
+
+// ------------------------------------------
+// ---------------- FAST LINK ---------------
+// ------------------------------------------
+
+struct {
+    const char* Name;
+    const char* Flag;
+    const char* GdbIndexProbe;
+} __Nom_FastLinkers[] = {
+    { "mold", "-fuse-ld=mold", "-fuse-ld=mold -Wl,--gdb-index" },
+    { "lld", "-fuse-ld=lld", "-fuse-ld=lld -Wl,--gdb-index" },
+    { "gold", "-fuse-ld=gold", "-fuse-ld=gold -Wl,--gdb-index" },
+};
+
+#define __NOM_FAST_LINKERS (sizeof(__Nom_FastLinkers) / sizeof(__Nom_FastLinkers[0]))
+
+int Nom_FastLinkProbe(const char* Compiler, Nom_FastLink* fl) {
+    _Bool HasLinker[__NOM_FAST_LINKERS];
+    _Bool HasGdbIndex[__NOM_FAST_LINKERS];
+    _Bool HasSplitDwarf;
+
+    Nom_Checks checks = {0};
+
+    for (u32 i = 0; i < __NOM_FAST_LINKERS; i++) {
+        Nom_CheckCompilerFlag(&checks, Compiler, __Nom_FastLinkers[i].Flag, &HasLinker[i]);
+        Nom_CheckCompilerFlag(&checks, Compiler, __Nom_FastLinkers[i].GdbIndexProbe, &HasGdbIndex[i]);
+    }
+
+    Nom_CheckCompilerFlag(&checks, Compiler, "-g -gsplit-dwarf", &HasSplitDwarf);
+
+    int Result = Nom_CheckRun(&checks);
+    Nom_FreeChecks(&checks);
+
+    memset(fl, 0, sizeof(Nom_FastLink));
+    fl->SplitDwarf = HasSplitDwarf;
+
+    for (u32 i = 0; i < __NOM_FAST_LINKERS; i++) {
+        if (HasLinker[i]) {
+            fl->Linker = __Nom_FastLinkers[i].Name;
+            fl->GdbIndex = HasSplitDwarf && HasGdbIndex[i];
+            break;
+        }
+    }
+
+    if (fl->Linker != NULL) {
+        NOM_INFO("Fast link: using %s%s%s", fl->Linker, fl->SplitDwarf ? ", split DWARF" : "", fl->GdbIndex ? ", gdb index" : "");
+    } else {
+        NOM_INFO("Fast link: no mold, lld or gold found, using the default linker");
+    }
+
+    return Result;
+}
+
+void Nom_FastLinkCompileFlags(Nom_FastLink fl, Nom_Cmd* cmd) {
+    if (fl.SplitDwarf) Nom_CmdAppend(cmd, "-gsplit-dwarf");
+
+    // --gdb-index is built from the pubnames sections, gcc only emits them when asked.
+    if (fl.GdbIndex) Nom_CmdAppend(cmd, "-ggnu-pubnames");
+}
+
+void Nom_FastLinkLinkFlags(Nom_FastLink fl, Nom_Cmd* cmd) {
+    for (u32 i = 0; fl.Linker != NULL && i < __NOM_FAST_LINKERS; i++) {
+        if (strcmp(fl.Linker, __Nom_FastLinkers[i].Name) == 0) {
+            Nom_CmdAppend(cmd, __Nom_FastLinkers[i].Flag);
+        }
+    }
+
+    if (fl.SplitDwarf) Nom_CmdAppend(cmd, "-gsplit-dwarf");
+    if (fl.GdbIndex) Nom_CmdAppend(cmd, "-Wl,--gdb-index");
+}
+
+// ------------------------------------------
+// ------------------ TEST ------------------
+// ------------------------------------------
+
+void __Nom_TestAdd(Nom_Tests* tests, const char* Name, ...) {
+    Nom_TestCase Test = {0};
+    Test.Name = Name;
+
+    va_list args;
+    VA_ARGS_FOREACH(args, arg, char*, Name, {
+        DA_APPEND(&Test.Cmd, arg);
+    })
+
+    DA_APPEND(tests, Test);
+}
+
+// Parses the value of a --name=N option, which must be a whole number between Min and Max.
+int __Nom_TestNumber(const char* Arg, u32 Skip, u32 Min, u32 Max, u32* Value) {
+    char* End = NULL;
+    errno = 0;
+    long long Number = strtoll(Arg + Skip, &End, 10);
+
+    if (End == Arg + Skip || *End != '\0' || errno != 0 || Number < Min || Number > Max) {
+        NOM_ERROR("Invalid option: %s, expected a number between %u and %u", Arg, Min, Max);
+        return -1;
+    }
+
+    *Value = (u32)Number;
+
+    return 0;
+}
+
+int Nom_TestArgs(Nom_Tests* tests, int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        const char* Arg = argv[i];
+
+        if (strncmp(Arg, "--shard=", 8) == 0) {
+            if (sscanf(Arg + 8, "%u/%u", &tests->Shard, &tests->ShardCount) != 2 ||
+                tests->Shard == 0 || tests->Shard > tests->ShardCount) {
+                NOM_ERROR("Invalid shard: %s, expected --shard=i/n with 1 <= i <= n", Arg + 8);
+                return -1;
+            }
+        } else if (strncmp(Arg, "--jobs=", 7) == 0) {
+            if (__Nom_TestNumber(Arg, 7, 1, 4096, &tests->MaxJobs) < 0) return -1;
+        } else if (strncmp(Arg, "--timeout=", 10) == 0) {
+            u32 Seconds;
+            if (__Nom_TestNumber(Arg, 10, 0, (u32)-1 / 1000, &Seconds) < 0) return -1;
+
+            tests->TimeoutMs = Seconds * 1000;
+        } else if (strncmp(Arg, "--retries=", 10) == 0) {
+            if (__Nom_TestNumber(Arg, 10, 0, 1000, &tests->Retries) < 0) return -1;
+        }
+    }
+
+    return 0;
+}
+
+// Durations of earlier runs are kept as "<ms>\t<name>" lines so the longest tests start first.
+void __Nom_TestLoadHistory(Nom_Tests* tests) {
+    const char* Path = PATH(NOM_CACHE_DIR, "tests");
+
+    u8* Data = NULL;
+    u32 Length = 0;
+    int Result = __Nom_ReadAll(Path, &Data, &Length);
+    NOM_FREE((char*)Path);
+
+    if (Result < 0) return;
+
+    char* Line = (char*)Data;
+
+    while (*Line != '\0') {
+        char* End = strchr(Line, '\n');
+        if (End != NULL) *End = '\0';
+
+        char* Tab = NULL;
+        i64 Duration = strtol(Line, &Tab, 10);
+
+        for (u32 i = 0; Tab != NULL && *Tab == '\t' && i < tests->Count; i++) {
+            if (strcmp(tests->Items[i].Name, Tab + 1) == 0) tests->Items[i].Expected = Duration;
+        }
+
+        if (End == NULL) break;
+        Line = End + 1;
+    }
+
+    NOM_FREE(Data);
+}
+
+void __Nom_TestSaveHistory(Nom_Tests* tests) {
+    const char* Path = PATH(NOM_CACHE_DIR, "tests");
+    FILE* file = Nom_FOpen(Path, "w");
+    NOM_FREE((char*)Path);
+
+    if (file == NULL) return;
+
+    for (u32 i = 0; i < tests->Count; i++) {
+        Nom_TestCase* Test = &tests->Items[i];
+
+        // Tests that did not run this time (other shards) keep their old timing.
+        i64 Duration = Test->Selected && Test->Passed ? Test->Duration : Test->Expected;
+        if (Duration >= 0) fprintf(file, "%ld\t%s\n", (long)Duration, Test->Name);
+    }
+
+    fclose(file);
+}
+
+int __Nom_TestCompareExpected(const void* a, const void* b) {
+    const Nom_TestCase* TestA = *(Nom_TestCase* const*)a;
+    const Nom_TestCase* TestB = *(Nom_TestCase* const*)b;
+
+    // Tests without a recorded duration sort first, they may well be the slowest.
+    i64 ExpectedA = TestA->Expected < 0 ? (i64)1 << 40 : TestA->Expected;
+    i64 ExpectedB = TestB->Expected < 0 ? (i64)1 << 40 : TestB->Expected;
+
+    return (ExpectedA < ExpectedB) - (ExpectedA > ExpectedB);
+}
+
+int __Nom_TestCompareDuration(const void* a, const void* b) {
+    const Nom_TestCase* TestA = *(Nom_TestCase* const*)a;
+    const Nom_TestCase* TestB = *(Nom_TestCase* const*)b;
+
+    return (TestA->Duration < TestB->Duration) - (TestA->Duration > TestB->Duration);
+}
+
+void __Nom_TestShowLog(const char* LogPath) {
+    u8* Log = NULL;
+    u32 LogLength = 0;
+
+    if (__Nom_ReadAll(LogPath, &Log, &LogLength) == 0) {
+        fflush(stdout);
+        fwrite(Log, 1, LogLength, stdout);
+        if (LogLength > 0 && Log[LogLength - 1] != '\n') fputc('\n', stdout);
+
+        NOM_FREE(Log);
+    }
+}
+
+typedef struct {
+    Nom_TestCase* Test;
+    Pid Proc;
+    i64 Start;
+    char LogPath[256];
+} __Nom_TestSlot;
+
+int Nom_TestRun(Nom_Tests* tests) {
+    u32 MaxJobs = tests->MaxJobs == 0 ? NOM_TEST_JOBS : tests->MaxJobs;
+
+    if (!Nom_IsDir(NOM_CACHE_DIR) && Nom_Mkdir(NOM_CACHE_DIR) < 0) return -1;
+
+    for (u32 i = 0; i < tests->Count; i++) {
+        Nom_TestCase* Test = &tests->Items[i];
+
+        Test->Expected = -1;
+        Test->Duration = 0;
+        Test->Attempts = 0;
+        Test->Passed = false;
+        Test->TimedOut = false;
+        Test->Selected = tests->ShardCount <= 1 || __Nom_PathHash(Test->Name) % tests->ShardCount == tests->Shard - 1;
+    }
+
+    __Nom_TestLoadHistory(tests);
+
+    Nom_TestCase** Queue = NOM_ALLOC((tests->Count + 1) * sizeof(Nom_TestCase*));
+    u32 QueueCount = 0;
+
+    for (u32 i = 0; i < tests->Count; i++) {
+        if (tests->Items[i].Selected) Queue[QueueCount++] = &tests->Items[i];
+    }
+
+    qsort(Queue, QueueCount, sizeof(Nom_TestCase*), __Nom_TestCompareExpected);
+
+    u32 Selected = QueueCount;
+    u32 Next = 0;
+
+    __Nom_TestSlot* Slots = NOM_ALLOC(MaxJobs * sizeof(__Nom_TestSlot));
+    NOM_ASSET(Slots != NULL);
+
+    // Logs carry the pid, so test runs sharing NOM_CACHE_DIR do not write into each other's logs.
+    for (u32 i = 0; i < MaxJobs; i++) {
+        Slots[i].Test = NULL;
+        snprintf(Slots[i].LogPath, sizeof(Slots[i].LogPath), "%s%ctest-%u-%u.log", NOM_CACHE_DIR, PATH_SEP, __Nom_ProcessId(), i);
+    }
+
+    if (tests->ShardCount > 1) {
+        NOM_INFO("Running %u of %u tests (shard %u/%u)", Selected, tests->Count, tests->Shard, tests->ShardCount);
+    } else {
+        NOM_INFO("Running %u tests", Selected);
+    }
+
+    i64 RunStart = __Nom_NowMs();
+    u32 Running = 0;
+
+    while (Next < QueueCount || Running > 0) {
+        for (u32 i = 0; i < MaxJobs && Next < QueueCount; i++) {
+            if (Slots[i].Test != NULL) continue;
+
+            Slots[i].Test = Queue[Next++];
+            Slots[i].Test->Attempts += 1;
+            Slots[i].Start = __Nom_NowMs();
+            Slots[i].Proc = __Nom_SpawnRedirect(Slots[i].Test->Cmd, Slots[i].LogPath);
+
+            Running += 1;
+        }
+
+        _Bool Finished = false;
+
+        for (u32 i = 0; i < MaxJobs; i++) {
+            Nom_TestCase* Test = Slots[i].Test;
+            if (Test == NULL) continue;
+
+            int ExitCode = 0;
+            i64 Elapsed = __Nom_NowMs() - Slots[i].Start;
+            _Bool TimedOut = tests->TimeoutMs > 0 && Elapsed > tests->TimeoutMs;
+
+            if (TimedOut) {
+                __Nom_Kill(Slots[i].Proc);
+                __Nom_WaitStatus(Slots[i].Proc);
+                ExitCode = -1;
+            } else if (!__Nom_TryWait(Slots[i].Proc, &ExitCode)) {
+                continue;
+            }
+
+            Slots[i].Test = NULL;
+            Running -= 1;
+            Finished = true;
+
+            Test->Duration = Elapsed;
+            Test->TimedOut = TimedOut;
+            Test->Passed = ExitCode == 0;
+
+            if (Test->Passed) {
+                if (Test->Attempts > 1) {
+                    NOM_WARN("FLAKY %s (%ld ms, passed on attempt %u)", Test->Name, (long)Elapsed, Test->Attempts);
+                } else {
+                    NOM_INFO("PASS  %s (%ld ms)", Test->Name, (long)Elapsed);
+                }
+            } else if (Test->Attempts <= tests->Retries) {
+                NOM_WARN("RETRY %s (%s, attempt %u)", Test->Name, TimedOut ? "timed out" : "failed", Test->Attempts);
+
+                // Retries go to the front of the queue so they finish with everything else.
+                Queue[--Next] = Test;
+            } else {
+                if (TimedOut) {
+                    NOM_ERROR("TIMEOUT %s (killed after %ld ms)", Test->Name, (long)Elapsed);
+                } else {
+                    NOM_ERROR("FAIL  %s (exit code %i, %ld ms)", Test->Name, ExitCode, (long)Elapsed);
+                }
+
+                __Nom_TestShowLog(Slots[i].LogPath);
+            }
+        }
+
+        if (!Finished && Running > 0) __Nom_SleepMs(2);
+    }
+
+    for (u32 i = 0; i < MaxJobs; i++) remove(Slots[i].LogPath);
+    NOM_FREE(Slots);
+
+    // Retries reused queue entries, so collect the selected tests again for the summary.
+    QueueCount = 0;
+
+    for (u32 i = 0; i < tests->Count; i++) {
+        if (tests->Items[i].Selected) Queue[QueueCount++] = &tests->Items[i];
+    }
+
+    u32 Passed = 0, Failed = 0, Flaky = 0, Retries = 0;
+
+    for (u32 i = 0; i < Selected; i++) {
+        Nom_TestCase* Test = Queue[i];
+
+        if (Test->Passed) Passed += 1; else Failed += 1;
+        if (Test->Passed && Test->Attempts > 1) Flaky += 1;
+
+        Retries += Test->Attempts - 1;
+    }
+
+    NOM_INFO("%u passed, %u failed, %u flaky (%u retries) in %ld ms", Passed, Failed, Flaky, Retries, (long)(__Nom_NowMs() - RunStart));
+
+    qsort(Queue, Selected, sizeof(Nom_TestCase*), __Nom_TestCompareDuration);
+
+    for (u32 i = 0; i < Selected && i < 5; i++) {
+        NOM_INFO("  slowest: %6ld ms  %s", (long)Queue[i]->Duration, Queue[i]->Name);
+    }
+
+    for (u32 i = 0; i < Selected; i++) {
+        if (Queue[i]->Attempts > 1) {
+            NOM_INFO("  retried: %u times  %s (%s)", Queue[i]->Attempts - 1, Queue[i]->Name, Queue[i]->Passed ? "flaky" : "failed");
+        }
+    }
+
+    __Nom_TestSaveHistory(tests);
+    NOM_FREE(Queue);
+
+    return Failed == 0 ? 0 : -1;
+}
+
+void Nom_FreeTests(Nom_Tests* tests) {
+    for (u32 i = 0; i < tests->Count; i++) {
+        Nom_FreeCmd(&tests->Items[i].Cmd);
+    }
+
+    NOM_FREE(tests->Items);
+    tests->Count = 0;
+    tests->Size = 0;
+}
+
+// ------------------------------------------
+// ------------------ SCAN ------------------
+// ------------------------------------------
+
+typedef struct {
+    char* Name;
+    _Bool Quoted;
+} __Nom_Include;
+
+// The includes of a file resolved against one set of search paths (SearchKey). The first
+// FoundCount targets exist, the rest are every place a missing include could appear, so a job
+// generating any of them is ordered first.
+typedef struct {
+    u32 SearchKey;
+    u32 FoundCount;
+    u32 TargetCount;
+    Nom_PathId* Targets;
+} __Nom_ScanResolved;
+
+// Indexed by Nom_PathId. Includes are scanned once per file and resolved once per distinct set of
+// search paths, every resolution is kept so configurations with different -I paths share them.
+typedef struct {
+    __Nom_Include* Items;
+    u32 Count;
+    u32 Size;
+
+    u8* Data;
+    _Bool Scanned;
+    u32 Visit;
+
+    __Nom_ScanResolved* Resolved;
+    u32 ResolvedCount;
+} __Nom_ScanEntry;
+
+typedef struct {
+    Nom_PathId* Items;
+    u32 Count;
+    u32 Size;
+} __Nom_ScanTargets;
+
+struct {
+    __Nom_ScanEntry* Items;
+    u32 Count;
+    u32 Size;
+
+    u32 Visit;
+} __Nom_Scans = {0};
+
+const char* __Nom_FindChar(const char* At, const char* End, char Chr) {
+    #if defined(__AVX2__)
+        __m256i Needle = _mm256_set1_epi8(Chr);
+
+        while (At + 32 <= End) {
+            u32 Mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)At), Needle));
+            if (Mask != 0) return At + __builtin_ctz(Mask);
+
+            At += 32;
+        }
+    #elif defined(__SSE2__)
+        __m128i Needle = _mm_set1_epi8(Chr);
+
+        while (At + 16 <= End) {
+            u32 Mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)At), Needle));
+            if (Mask != 0) return At + __builtin_ctz(Mask);
+
+            At += 16;
+        }
+    #endif
+
+    while (At < End && *At != Chr) At += 1;
+
+    return At;
+}
+
+__Nom_ScanEntry* __Nom_ScanGet(Nom_PathId Id) {
+    while (__Nom_Scans.Count <= Id) {
+        __Nom_ScanEntry Entry = {0};
+        DA_APPEND(&__Nom_Scans, Entry);
+    }
+
+    return &__Nom_Scans.Items[Id];
+}
+
+void __Nom_ScanFile(Nom_PathId Id) {
+    u8* Data = NULL;
+    u32 Length = 0;
+
+    __Nom_ScanGet(Id)->Scanned = true;
+
+    if (__Nom_ReadAll(Nom_PathStr(Id), &Data, &Length) < 0) return;
+
+    // Names are cut out of Data in place and Data is kept as their storage, the include list is
+    // sized exactly once the file is done since most headers include only a handful of others.
+    static __Nom_Include* Found = NULL;
+    static u32 FoundSize = 0;
+    u32 FoundCount = 0;
+
+    const char* Start = (const char*)Data;
+    const char* End = Start + Length;
+    const char* At = Start;
+
+    while ((At = __Nom_FindChar(At, End, '#')) < End) {
+        const char* Line = At;
+        while (Line > Start && (Line[-1] == ' ' || Line[-1] == '\t')) Line -= 1;
+
+        At += 1;
+        if (Line != Start && Line[-1] != '\n') continue;
+
+        while (At < End && (*At == ' ' || *At == '\t')) At += 1;
+        if (End - At < 7 || memcmp(At, "include", 7) != 0) continue;
+
+        At += 7;
+        while (At < End && (*At == ' ' || *At == '\t')) At += 1;
+        if (At >= End || (*At != '"' && *At != '<')) continue;
+
+        char Close = *At == '"' ? '"' : '>';
+        const char* Name = At + 1;
+        const char* NameEnd = Name;
+
+        while (NameEnd < End && *NameEnd != Close && *NameEnd != '\n') NameEnd += 1;
+        if (NameEnd >= End || *NameEnd != Close || NameEnd == Name) continue;
+
+        if (FoundCount >= FoundSize) {
+            FoundSize = FoundSize == 0 ? 64 : FoundSize * 2;
+            Found = NOM_REALLOC(Found, FoundSize * sizeof(__Nom_Include));
+            NOM_ASSET(Found != NULL);
+        }
+
+        Found[FoundCount].Name = (char*)Name;
+        Found[FoundCount].Quoted = Close == '"';
+        FoundCount += 1;
+
+        ((char*)NameEnd)[0] = '\0';
+        At = NameEnd + 1;
+    }
+
+    if (FoundCount == 0) {
+        NOM_FREE(Data);
+        return;
+    }
+
+    __Nom_ScanEntry* Entry = __Nom_ScanGet(Id);
+
+    Entry->Items = NOM_ALLOC(FoundCount * sizeof(__Nom_Include));
+    Entry->Count = FoundCount;
+    Entry->Size = FoundCount;
+    Entry->Data = Data;
+
+    memcpy(Entry->Items, Found, FoundCount * sizeof(__Nom_Include));
+}
+
+Nom_PathId __Nom_ScanLookup(const char* Dir, const char* Name) {
+    char Candidate[4096];
+
+    if (snprintf(Candidate, sizeof(Candidate), "%s%c%s", Dir, PATH_SEP, Name) >= (int)sizeof(Candidate)) {
+        return NOM_NO_PATH;
+    }
+
+    // Most misses are for "dir/header.h" under the wrong search path, checking the (shared and
+    // cached) directory first saves a stat of every such candidate.
+    char* Sep = strrchr(Candidate, '/');
+
+    if (Sep != NULL && Sep > Candidate + strlen(Dir) + 1) {
+        *Sep = '\0';
+        _Bool HasDir = Nom_PathStat(Nom_PathIntern(Candidate), NULL);
+        *Sep = '/';
+
+        if (!HasDir) return NOM_NO_PATH;
+    }
+
+    Nom_PathId Id = Nom_PathIntern(Candidate);
+    return Nom_PathStat(Id, NULL) ? Id : NOM_NO_PATH;
+}
+
+// Dirs holds the -iquote dirs first, then -I, then -isystem; angle includes skip the first QuoteCount.
+// Returns the index of the resolution for SearchKey in Resolved.
+u32 __Nom_ScanResolve(Nom_PathId Id, const char** Dirs, u32 DirCount, u32 QuoteCount, u32 SearchKey) {
+    for (u32 r = 0; r < __Nom_ScanGet(Id)->ResolvedCount; r++) {
+        if (__Nom_ScanGet(Id)->Resolved[r].SearchKey == SearchKey) return r;
+    }
+
+    char IncluderDir[4096] = ".";
+    const char* Path = Nom_PathStr(Id);
+    const char* Sep = strrchr(Path, PATH_SEP);
+
+    if (Sep != NULL && Sep - Path < (long)sizeof(IncluderDir)) {
+        u32 Length = Sep == Path ? 1 : Sep - Path;
+        memcpy(IncluderDir, Path, Length);
+        IncluderDir[Length] = '\0';
+    }
+
+    __Nom_ScanTargets Found = {0}, Missing = {0};
+
+    for (u32 i = 0; i < __Nom_ScanGet(Id)->Count; i++) {
+        __Nom_Include Include = __Nom_ScanGet(Id)->Items[i];
+        Nom_PathId Target = NOM_NO_PATH;
+
+        if (Include.Quoted) Target = __Nom_ScanLookup(IncluderDir, Include.Name);
+
+        for (u32 d = Include.Quoted ? 0 : QuoteCount; Target == NOM_NO_PATH && d < DirCount; d++) {
+            Target = __Nom_ScanLookup(Dirs[d], Include.Name);
+        }
+
+        if (Target != NOM_NO_PATH) {
+            DA_APPEND(&Found, Target);
+            continue;
+        }
+
+        // Quoted includes are also looked for next to the includer, angle ones only on the search paths.
+        u32 DirEnd = Include.Quoted ? DirCount + 1 : DirCount;
+
+        for (u32 d = Include.Quoted ? 0 : QuoteCount; d < DirEnd; d++) {
+            const char* Dir = d < DirCount ? Dirs[d] : IncluderDir;
+            char Candidate[4096];
+
+            if (snprintf(Candidate, sizeof(Candidate), "%s%c%s", Dir, PATH_SEP, Include.Name) < (int)sizeof(Candidate)) {
+                DA_APPEND(&Missing, Nom_PathIntern(Candidate));
+            }
+        }
+    }
+
+    __Nom_ScanResolved Resolved = {0};
+    Resolved.SearchKey = SearchKey;
+    Resolved.FoundCount = Found.Count;
+    Resolved.TargetCount = Found.Count + Missing.Count;
+    Resolved.Targets = NOM_ALLOC((Resolved.TargetCount + 1) * sizeof(Nom_PathId));
+
+    if (Found.Count > 0) memcpy(Resolved.Targets, Found.Items, Found.Count * sizeof(Nom_PathId));
+    if (Missing.Count > 0) memcpy(Resolved.Targets + Found.Count, Missing.Items, Missing.Count * sizeof(Nom_PathId));
+
+    NOM_FREE(Found.Items);
+    NOM_FREE(Missing.Items);
+
+    __Nom_ScanEntry* Entry = __Nom_ScanGet(Id);
+
+    Entry->Resolved = NOM_REALLOC(Entry->Resolved, (Entry->ResolvedCount + 1) * sizeof(__Nom_ScanResolved));
+    NOM_ASSET(Entry->Resolved != NULL);
+
+    Entry->Resolved[Entry->ResolvedCount] = Resolved;
+    Entry->ResolvedCount += 1;
+
+    return Entry->ResolvedCount - 1;
+}
+
+// Like the compiler, looks in the working directory first and then along the quote chain. A missing
+// file is recorded in the working directory.
+Nom_PathId __Nom_ScanForced(const char* Name, const char** Dirs, u32 DirCount) {
+    Nom_PathId Id = Nom_PathIntern(Name);
+    if (Nom_PathStat(Id, NULL)) return Id;
+
+    for (u32 d = 0; d < DirCount; d++) {
+        Nom_PathId Target = __Nom_ScanLookup(Dirs[d], Name);
+        if (Target != NOM_NO_PATH) return Target;
+    }
+
+    return Id;
+}
+
+int Nom_ScanDeps(Nom_Cmd cmd, Nom_Deps* deps) {
+    const char** Dirs = NOM_ALLOC((cmd.Count + 1) * sizeof(char*));
+    u32 DirCount = 0, QuoteCount = 0;
+
+    // Quote dirs go first so a single array serves both kinds of include.
+    static const char* Kinds[] = { "-iquote", "-I", "-isystem" };
+
+    for (u32 k = 0; k < 3; k++) {
+        u32 KindLength = strlen(Kinds[k]);
+
+        for (u32 i = 1; i < cmd.Count; i++) {
+            if (strncmp(cmd.Items[i], Kinds[k], KindLength) != 0) continue;
+
+            if (cmd.Items[i][KindLength] != '\0') {
+                Dirs[DirCount++] = cmd.Items[i] + KindLength;
+            } else if (i + 1 < cmd.Count) {
+                Dirs[DirCount++] = cmd.Items[++i];
+            }
+        }
+
+        if (k == 0) QuoteCount = DirCount;
+    }
+
+    u32 SearchKey = 2166136261u ^ QuoteCount;
+
+    for (u32 d = 0; d < DirCount; d++) {
+        SearchKey = (SearchKey ^ __Nom_PathHash(Dirs[d])) * 16777619u;
+    }
+
+    SearchKey |= 1;
+
+    u32 StackCount = 0, StackSize = 64;
+    Nom_PathId* Stack = NOM_ALLOC(StackSize * sizeof(Nom_PathId));
+
+    __Nom_Scans.Visit += 1;
+
+    for (u32 i = 1; i < cmd.Count; i++) {
+        const char* Arg = cmd.Items[i];
+        Nom_PathId Root;
+
+        if (strcmp(Arg, "-include-pch") == 0) {
+            i += 1;
+            continue;
+        }
+
+        if (strncmp(Arg, "-include", 8) == 0 || strncmp(Arg, "-imacros", 8) == 0) {
+            const char* Name = Arg + 8;
+
+            if (*Name == '\0') {
+                if (i + 1 >= cmd.Count) continue;
+                Name = cmd.Items[++i];
+            }
+
+            Root = __Nom_ScanForced(Name, Dirs, DirCount);
+            if (__Nom_ScanGet(Root)->Visit == __Nom_Scans.Visit) continue;
+
+            DA_APPEND(deps, Root);
+        } else if (Arg[0] != '-' && __Nom_IsSource(Arg)) {
+            Root = Nom_PathIntern(Arg);
+        } else {
+            continue;
+        }
+
+        __Nom_ScanGet(Root)->Visit = __Nom_Scans.Visit;
+
+        StackCount = 0;
+        Stack[StackCount++] = Root;
+
+        while (StackCount > 0) {
+            Nom_PathId Id = Stack[--StackCount];
+
+            if (!__Nom_ScanGet(Id)->Scanned) __Nom_ScanFile(Id);
+            u32 r = __Nom_ScanResolve(Id, Dirs, DirCount, QuoteCount, SearchKey);
+
+            // Resolved is a separate allocation, growing __Nom_Scans below does not move it.
+            __Nom_ScanResolved Resolved = __Nom_ScanGet(Id)->Resolved[r];
+
+            for (u32 n = 0; n < Resolved.TargetCount; n++) {
+                Nom_PathId Target = Resolved.Targets[n];
+                if (__Nom_ScanGet(Target)->Visit == __Nom_Scans.Visit) continue;
+
+                __Nom_ScanGet(Target)->Visit = __Nom_Scans.Visit;
+                DA_APPEND(deps, Target);
+
+                // Missing headers have nothing to follow.
+                if (n >= Resolved.FoundCount) continue;
+
+                if (StackCount >= StackSize) {
+                    StackSize *= 2;
+                    Stack = NOM_REALLOC(Stack, StackSize * sizeof(Nom_PathId));
+                }
+
+                Stack[StackCount++] = Target;
+            }
+        }
+    }
+
+    NOM_FREE(Stack);
+    NOM_FREE(Dirs);
+
+    return 0;
+}
+
+void __Nom_ScanForget(Nom_PathId Id) {
+    if (Id >= __Nom_Scans.Count) return;
+
+    __Nom_ScanEntry* Entry = &__Nom_Scans.Items[Id];
+
+    NOM_FREE(Entry->Items);
+    NOM_FREE(Entry->Data);
+
+    for (u32 r = 0; r < Entry->ResolvedCount; r++) NOM_FREE(Entry->Resolved[r].Targets);
+    NOM_FREE(Entry->Resolved);
+
+    u32 Visit = Entry->Visit;
+    memset(Entry, 0, sizeof(__Nom_ScanEntry));
+    Entry->Visit = Visit;
+}
+
+void __Nom_FreeScans(void) {
+    for (u32 Id = 0; Id < __Nom_Scans.Count; Id++) __Nom_ScanForget(Id);
+
+    NOM_FREE(__Nom_Scans.Items);
+    memset(&__Nom_Scans, 0, sizeof(__Nom_Scans));
+}
+
+// True if any of Outputs is missing or older than any input of cmd or scanned header. Arguments
+// naming one of the outputs are not inputs.
+_Bool __Nom_CmdIsStaleOutputs(Nom_Cmd cmd, const Nom_PathId* Outputs, u32 OutputCount) {
+    // Flags whose value is a separate argument that is not an input of the command.
+    static const char* Valued[] = {
+        "-o", "-I", "-iquote", "-isystem", "-idirafter", "-include", "-imacros",
+        "-MF", "-MT", "-MQ", "-x", "-L", "-D", "-U", "-Xlinker"
+    };
+
+    if (OutputCount == 0) return true;
+
+    i64 Output = -1;
+
+    for (u32 o = 0; o < OutputCount; o++) {
+        i64 Mtime = Nom_Mtime(Nom_PathStr(Outputs[o]));
+        if (Mtime < 0) return true;
+
+        if (Output < 0 || Mtime < Output) Output = Mtime;
+    }
+
+    for (u32 i = 1; i < cmd.Count; i++) {
+        const char* Arg = cmd.Items[i];
+
+        if (Arg[0] == '-') {
+            for (u32 v = 0; v < sizeof(Valued) / sizeof(Valued[0]); v++) {
+                if (strcmp(Arg, Valued[v]) == 0) i += 1;
+            }
+
+            continue;
+        }
+
+        Nom_PathId Id = Nom_PathIntern(Arg);
+        _Bool IsOutput = false;
+
+        for (u32 o = 0; o < OutputCount; o++) {
+            if (Outputs[o] == Id) IsOutput = true;
+        }
+
+        if (!IsOutput && Nom_Mtime(Arg) > Output) return true;
+    }
+
+    Nom_Deps deps = {0};
+    Nom_ScanDeps(cmd, &deps);
+
+    _Bool Stale = false;
+
+    for (u32 i = 0; i < deps.Count && !Stale; i++) {
+        Stale = Nom_Mtime(Nom_PathStr(deps.Items[i])) > Output;
+    }
+
+    Nom_FreeDeps(&deps);
+
+    return Stale;
+}
+
+_Bool Nom_CmdIsStale(Nom_Cmd cmd) {
+    Nom_PathId Output = NOM_NO_PATH;
+    u32 OutputCount = 0;
+
+    for (u32 i = 1; i + 1 < cmd.Count; i++) {
+        if (strcmp(cmd.Items[i], "-o") == 0) {
+            Output = Nom_PathIntern(cmd.Items[i + 1]);
+            OutputCount += 1;
+        }
+    }
+
+    if (OutputCount != 1) return true;
+
+    return __Nom_CmdIsStaleOutputs(cmd, &Output, 1);
+}
+
+void Nom_FreeDeps(Nom_Deps* deps) {
+    NOM_FREE(deps->Items);
+    deps->Count = 0;
+    deps->Size = 0;
+}
+
+// ------------------------------------------
+// ------------------ BUILD -----------------
+// ------------------------------------------
+
+u32 Nom_BuildJob(Nom_Build* build, Nom_Cmd cmd) {
+    Nom_Job Job = {0};
+    Job.Cmd = cmd;
+    Job.Config = build->ConfigIndex;
+
+    if (build->ConfigIndex + 1 > build->ConfigCount) build->ConfigCount = build->ConfigIndex + 1;
+
+    DA_APPEND(build, Job);
+
+    return build->Count - 1;
+}
+
+void Nom_BuildAfter(Nom_Build* build, u32 Job, u32 Dep) {
+    NOM_ASSET(Job < build->Count && Dep < build->Count);
+    DA_APPEND(&build->Items[Job].Deps, Dep);
+}
+
+void Nom_BuildOutput(Nom_Build* build, u32 Job, const char* Path) {
+    NOM_ASSET(Job < build->Count);
+    DA_APPEND(&build->Items[Job].Outputs, Nom_PathIntern(Path));
+}
+
+_Bool __Nom_BuildIsStale(Nom_Job* Job) {
+    if (Job->Outputs.Count == 0) return Nom_CmdIsStale(Job->Cmd);
+    return __Nom_CmdIsStaleOutputs(Job->Cmd, Job->Outputs.Items, Job->Outputs.Count);
+}
+
+void __Nom_BuildInvalidate(Nom_Job* Job) {
+    if (Job->Outputs.Count == 0) {
+        __Nom_CmdInvalidateOutput(Job->Cmd);
+        return;
+    }
+
+    for (u32 o = 0; o < Job->Outputs.Count; o++) {
+        Nom_PathInvalidate(Nom_PathStr(Job->Outputs.Items[o]));
+    }
+}
+
+void __Nom_MkdirAll(const char* Path) {
+    if (Nom_IsDir(Path)) return;
+
+    char* Parent = (char*)CONCAT(Path);
+    char* Sep = strrchr(Parent, PATH_SEP);
+
+    if (Sep != NULL && Sep != Parent) {
+        *Sep = '\0';
+        __Nom_MkdirAll(Parent);
+    }
+
+    NOM_FREE(Parent);
+    Nom_Mkdir(Path);
+}
+
+void Nom_ConfigFlags(const Nom_Config* config, Nom_Cmd* cmd) {
+    for (u32 i = 0; i < config->Flags.Count; i++) {
+        DA_APPEND(cmd, config->Flags.Items[i]);
+    }
+}
+
+const char* Nom_ConfigPath(const Nom_Config* config, const char* Name) {
+    const char* Path = PATH(config->OutDir, Name);
+
+    char* Dir = (char*)CONCAT(Path);
+    char* Sep = strrchr(Dir, PATH_SEP);
+
+    if (Sep != NULL) {
+        *Sep = '\0';
+        __Nom_MkdirAll(Dir);
+    }
+
+    NOM_FREE(Dir);
+
+    return Path;
+}
+
+// Orders every job after the jobs whose outputs it reads, either as an argument or as a scanned
+// header. This is what makes generators safe: a job declaring gen/x.h (its -o or Nom_BuildOutput)
+// runs before any compile including "x.h" from gen, even before the header exists.
+void __Nom_BuildLinkOutputs(Nom_Build* build) {
+    u32* Producer = NULL;
+    u32 ProducerCount = 0;
+
+    for (u32 j = 0; j < build->Count; j++) {
+        Nom_Job* Job = &build->Items[j];
+        Nom_JobOutputs Outputs = Job->Outputs;
+        Nom_PathId Output;
+
+        if (Outputs.Count == 0) {
+            for (u32 i = 1; i + 1 < Job->Cmd.Count; i++) {
+                if (strcmp(Job->Cmd.Items[i], "-o") != 0) continue;
+
+                Output = Nom_PathIntern(Job->Cmd.Items[i + 1]);
+                Outputs.Items = &Output;
+                Outputs.Count = 1;
+            }
+        }
+
+        for (u32 o = 0; o < Outputs.Count; o++) {
+            if (Outputs.Items[o] >= ProducerCount) {
+                u32 Count = __Nom_Paths.Count;
+
+                Producer = NOM_REALLOC(Producer, Count * sizeof(u32));
+                NOM_ASSET(Producer != NULL);
+
+                memset(Producer + ProducerCount, 0xff, (Count - ProducerCount) * sizeof(u32));
+                ProducerCount = Count;
+            }
+
+            Producer[Outputs.Items[o]] = j;
+        }
+    }
+
+    if (ProducerCount == 0) return;
+
+    Nom_Deps deps = {0};
+
+    for (u32 j = 0; j < build->Count; j++) {
+        Nom_Job* Job = &build->Items[j];
+
+        deps.Count = 0;
+        Nom_ScanDeps(Job->Cmd, &deps);
+
+        for (u32 i = 1; i < Job->Cmd.Count; i++) {
+            if (Job->Cmd.Items[i][0] != '-') DA_APPEND(&deps, Nom_PathIntern(Job->Cmd.Items[i]));
+        }
+
+        for (u32 d = 0; d < deps.Count; d++) {
+            if (deps.Items[d] >= ProducerCount) continue;
+
+            u32 Dep = Producer[deps.Items[d]];
+            if (Dep == (u32)-1 || Dep == j) continue;
+
+            _Bool Known = false;
+
+            for (u32 k = 0; k < Job->Deps.Count; k++) {
+                if (Job->Deps.Items[k] == Dep) Known = true;
+            }
+
+            if (!Known) DA_APPEND(&Job->Deps, Dep);
+        }
+    }
+
+    Nom_FreeDeps(&deps);
+    NOM_FREE(Producer);
+}
+
+typedef struct {
+    u32 Job;
+    Pid Proc;
+} __Nom_BuildSlot;
+
+int Nom_BuildRun(Nom_Build* build) {
+    u32 MaxJobs = build->MaxJobs == 0 ? NOM_BUILD_JOBS : build->MaxJobs;
+    u32 ConfigCount = build->ConfigCount == 0 ? 1 : build->ConfigCount;
+    u32 JobCount = build->Count;
+
+    __Nom_BuildLinkOutputs(build);
+
+    // Dependents of job j are Dependents[First[j] .. First[j + 1]).
+    u32* First = NOM_ALLOC((JobCount + 1) * sizeof(u32));
+    u32* Dependents = NULL;
+
+    memset(First, 0, (JobCount + 1) * sizeof(u32));
+
+    for (u32 j = 0; j < JobCount; j++) {
+        Nom_Job* Job = &build->Items[j];
+
+        Job->Waiting = Job->Deps.Count;
+        Job->DepRan = false;
+        Job->Ran = false;
+        Job->Failed = false;
+
+        for (u32 d = 0; d < Job->Deps.Count; d++) First[Job->Deps.Items[d] + 1] += 1;
+    }
+
+    for (u32 j = 0; j < JobCount; j++) First[j + 1] += First[j];
+
+    Dependents = NOM_ALLOC((First[JobCount] + 1) * sizeof(u32));
+    u32* Fill = NOM_ALLOC((JobCount + 1) * sizeof(u32));
+    memcpy(Fill, First, (JobCount + 1) * sizeof(u32));
+
+    for (u32 j = 0; j < JobCount; j++) {
+        Nom_JobDeps* Deps = &build->Items[j].Deps;
+        for (u32 d = 0; d < Deps->Count; d++) Dependents[Fill[Deps->Items[d]]++] = j;
+    }
+
+    NOM_FREE(Fill);
+
+    // One FIFO of ready jobs per configuration, served round robin so every configuration
+    // makes progress and no configuration's link step waits behind another's compiles.
+    u32* Ready = NOM_ALLOC((JobCount + 1) * ConfigCount * sizeof(u32));
+    u32* Head = NOM_ALLOC(ConfigCount * sizeof(u32));
+    u32* Tail = NOM_ALLOC(ConfigCount * sizeof(u32));
+
+    memset(Head, 0, ConfigCount * sizeof(u32));
+    memset(Tail, 0, ConfigCount * sizeof(u32));
+
+    #define __NOM_READY_PUSH(j) do {                                  \
+        u32 __Config = build->Items[j].Config;                        \
+        Ready[__Config * (JobCount + 1) + Tail[__Config]++] = (j);    \
+    } while (0)
+
+    for (u32 j = 0; j < JobCount; j++) {
+        if (build->Items[j].Waiting == 0) __NOM_READY_PUSH(j);
+    }
+
+    __Nom_BuildSlot* Slots = NOM_ALLOC(MaxJobs * sizeof(__Nom_BuildSlot));
+    u32 Running = 0, NextConfig = 0;
+    u32 Done = 0, Ran = 0, Failed = 0;
+
+    i64 Start = __Nom_NowMs();
+
+    while (Done < JobCount && (Running > 0 || Failed == 0)) {
+        // Fill free slots; up to date jobs finish on the spot and may make more jobs ready.
+        _Bool Progress = false;
+
+        while (Failed == 0 && Running < MaxJobs) {
+            u32 c = 0;
+            while (c < ConfigCount && Head[(NextConfig + c) % ConfigCount] == Tail[(NextConfig + c) % ConfigCount]) c += 1;
+            if (c == ConfigCount) break;
+
+            u32 Config = (NextConfig + c) % ConfigCount;
+            u32 j = Ready[Config * (JobCount + 1) + Head[Config]++];
+            NextConfig = (Config + 1) % ConfigCount;
+
+            Nom_Job* Job = &build->Items[j];
+
+            if (!Job->DepRan && !__Nom_BuildIsStale(Job)) {
+                Done += 1;
+                Progress = true;
+
+                for (u32 d = First[j]; d < First[j + 1]; d++) {
+                    if (--build->Items[Dependents[d]].Waiting == 0) __NOM_READY_PUSH(Dependents[d]);
+                }
+
+                continue;
+            }
+
+            __Nom_BuildInvalidate(Job);
+
+            Slots[Running].Job = j;
+            Slots[Running].Proc = Nom_CmdRun_Async(Job->Cmd);
+            Running += 1;
+        }
+
+        for (u32 s = 0; s < Running;) {
+            int ExitCode = 0;
+
+            if (!__Nom_TryWait(Slots[s].Proc, &ExitCode)) {
+                s += 1;
+                continue;
+            }
+
+            u32 j = Slots[s].Job;
+            Nom_Job* Job = &build->Items[j];
+
+            Slots[s] = Slots[--Running];
+            Done += 1;
+            Progress = true;
+
+            __Nom_BuildInvalidate(Job);
+
+            if (ExitCode != 0) {
+                NOM_ERROR("command exited with exit code %i", ExitCode);
+                Job->Failed = true;
+                Failed += 1;
+                continue;
+            }
+
+            Job->Ran = true;
+            Ran += 1;
+
+            for (u32 d = First[j]; d < First[j + 1]; d++) {
+                Nom_Job* Dependent = &build->Items[Dependents[d]];
+                Dependent->DepRan = true;
+
+                if (--Dependent->Waiting == 0) __NOM_READY_PUSH(Dependents[d]);
+            }
+        }
+
+        if (!Progress && Running > 0) __Nom_SleepMs(1);
+        if (!Progress && Running == 0) break;
+    }
+
+    #undef __NOM_READY_PUSH
+
+    if (Failed == 0 && Done < JobCount) {
+        NOM_ERROR("Build graph has a dependency cycle, %u jobs never became ready", JobCount - Done);
+    }
+
+    NOM_INFO("Build: %u ran, %u up to date, %u failed in %ld ms", Ran, Done - Ran - Failed, Failed, (long)(__Nom_NowMs() - Start));
+
+    NOM_FREE(Slots);
+    NOM_FREE(Ready);
+    NOM_FREE(Head);
+    NOM_FREE(Tail);
+    NOM_FREE(Dependents);
+    NOM_FREE(First);
+
+    return Failed == 0 && Done == JobCount ? 0 : -1;
+}
+
+int Nom_BuildConfigs(const Nom_Config* Configs, u32 Count, Nom_Targets Targets, u32 MaxJobs) {
+    Nom_Build build = {0};
+    build.MaxJobs = MaxJobs;
+
+    for (u32 i = 0; i < Count; i++) {
+        build.Config = &Configs[i];
+        build.ConfigIndex = i;
+
+        Targets(&build, &Configs[i]);
+    }
+
+    int Result = Nom_BuildRun(&build);
+    Nom_FreeBuild(&build);
+
+    return Result;
+}
+
+void Nom_FreeBuild(Nom_Build* build) {
+    for (u32 j = 0; j < build->Count; j++) {
+        Nom_FreeCmd(&build->Items[j].Cmd);
+        NOM_FREE(build->Items[j].Deps.Items);
+        NOM_FREE(build->Items[j].Outputs.Items);
+    }
+
+    NOM_FREE(build->Items);
+    build->Count = 0;
+    build->Size = 0;
 }
 
 #endif // _NOM_IMPLEMENTATION_
\ No newline at end of file